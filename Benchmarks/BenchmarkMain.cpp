@@ -0,0 +1,48 @@
+#include "Benchmarks.h"
+#include <JuceHeader.h>
+
+namespace {
+
+struct Benchmark {
+  const char *name;
+  void (*run)();
+};
+
+constexpr Benchmark benchmarks[] = {
+    {"kernels", &Benchmarks::runKernelBenchmarks},
+    {"voices", &Benchmarks::runVoiceManagerBenchmarks},
+    {"chordvoices", &Benchmarks::runChordVoiceBenchmarks},
+    {"midi", &Benchmarks::runMidiLayerBenchmarks},
+};
+
+} // namespace
+
+// Runs every benchmark, or only those named on the command line
+int main(int argc, char *argv[]) {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+  int numRun = 0;
+  for (const auto &benchmark : benchmarks) {
+    bool selected = argc <= 1;
+    for (int i = 1; i < argc; ++i)
+      selected = selected || juce::String(argv[i]) == benchmark.name;
+
+    if (!selected)
+      continue;
+
+    std::printf("== %s ==\n", benchmark.name);
+    benchmark.run();
+    std::printf("\n");
+    ++numRun;
+  }
+
+  if (numRun == 0) {
+    std::printf("Unknown benchmark. Available:");
+    for (const auto &benchmark : benchmarks)
+      std::printf(" %s", benchmark.name);
+    std::printf("\n");
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+// Micro-benchmarks for the render and MIDI paths. Each one prints its own
+// table; build in Release for meaningful numbers.
+namespace Benchmarks {
+
+// Samples per second of each voice kernel, for every instruction set the
+// CPU supports
+void runKernelBenchmarks();
+
+// Note-on latency and block overhead of VoiceManager at full polyphony,
+// against the juce::Synthesiser voices it replaced
+void runVoiceManagerBenchmarks();
+
+// Chords rendered on chord voices (one envelope and filter per chord)
+// against one voice per note
+void runChordVoiceBenchmarks();
+
+// Per-block cost of processBlock at 32-sample buffers with each MIDI-layer
+// stage on, against the pass-through path with both off
+void runMidiLayerBenchmarks();
+
+// Seconds taken by function(), best of a few runs to skip warm-up noise
+template <typename Function>
+double measureSeconds(Function &&function, int runs = 3) {
+  double best = 0.0;
+  for (int run = 0; run < runs; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    if (run == 0 || elapsed.count() < best)
+      best = elapsed.count();
+  }
+  return best;
+}
+
+} // namespace Benchmarks
@@ -0,0 +1,188 @@
+#include "Benchmarks.h"
+#include "VoiceBankKernels.h"
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace VoiceBankKernels;
+
+constexpr int numVoices = 64; // A multiple of every kernel width
+constexpr int chunkSize = maxChunkSize;
+constexpr int numChunks = 4000;
+constexpr double sampleRate = 48000.0;
+
+// Voice state for one chunk layout, set up the way VoiceBank feeds the
+// kernels: every voice playing, each at its own pitch
+struct KernelInputs {
+  KernelInputs() {
+    for (int voice = 0; voice < numVoices; ++voice) {
+      const auto v = (size_t)voice;
+      const auto frequency = 110.0 * std::pow(2.0, voice / 12.0);
+      increment[v] = (float)(frequency / sampleRate);
+      inverseIncrement[v] = 1.0f / increment[v];
+      tables[v] = table.data();
+    }
+
+    for (int i = 0; i <= wavetableSize; ++i)
+      table[(size_t)i] =
+          (float)std::sin(juce::MathConstants<double>::twoPi * i /
+                          wavetableSize);
+
+    // Butterworth low-pass at 2 kHz, coefficients as in VoiceBank
+    const auto g = (float)std::tan(juce::MathConstants<double>::pi * 2000.0 /
+                                   sampleRate);
+    const auto r2 = std::sqrt(2.0f);
+    std::fill(filterG.begin(), filterG.end(), g);
+    std::fill(filterR2.begin(), filterR2.end(), r2);
+    std::fill(filterH.begin(), filterH.end(), 1.0f / (1.0f + r2 * g + g * g));
+  }
+
+  ChunkLayout layout() {
+    return {chunkSize, numVoices, active.data(), mix.data()};
+  }
+
+  EnvelopeBlock envelope() {
+    const EnvelopeSegment segment{multiplier.data(), offset.data(),
+                                  floor.data(), ceiling.data()};
+    return {envelopeLevel.data(), segment, segment, switchLevel.data(),
+            switched.data(), envelopeOutput.data()};
+  }
+
+  OscillatorBlock oscillator(Waveform waveform, bool accumulate) {
+    return {waveform,     0.5f,
+            0.0f,         accumulate,
+            phase.data(), increment.data(),
+            inverseIncrement.data(), tables.data()};
+  }
+
+  PostBlock post() {
+    return {filterS1.data(),
+            filterS2.data(),
+            filterG.data(),
+            filterR2.data(),
+            filterH.data(),
+            zeros.data(),
+            zeros.data(),
+            zeros.data(),
+            true,
+            envelopeOutput.data(),
+            0.25f,
+            panLeft.data(),
+            panRight.data(),
+            left.data(),
+            right.data(),
+            peak.data()};
+  }
+
+  using Voices = std::vector<float>;
+  using Samples = std::vector<float>;
+
+  Voices active = Voices(numVoices, 1.0f);
+  Samples mix = Samples(numVoices * chunkSize, 0.0f);
+
+  // Envelope held at a sustain level
+  Voices envelopeLevel = Voices(numVoices, 0.5f);
+  Voices multiplier = Voices(numVoices, 1.0f);
+  Voices offset = Voices(numVoices, 0.0f);
+  Voices floor = Voices(numVoices, 0.0f);
+  Voices ceiling = Voices(numVoices, 1.0f);
+  Voices switchLevel = Voices(numVoices, noSwitchLevel);
+  Voices switched = Voices(numVoices, 0.0f);
+  Samples envelopeOutput = Samples(numVoices * chunkSize, 0.5f);
+
+  Voices phase = Voices(numVoices, 0.0f);
+  Voices increment = Voices(numVoices);
+  Voices inverseIncrement = Voices(numVoices);
+  std::vector<const float *> tables = std::vector<const float *>(numVoices);
+  std::vector<float> table = std::vector<float>(wavetableSize + 1);
+
+  Voices filterS1 = Voices(numVoices, 0.0f);
+  Voices filterS2 = Voices(numVoices, 0.0f);
+  Voices filterG = Voices(numVoices);
+  Voices filterR2 = Voices(numVoices);
+  Voices filterH = Voices(numVoices);
+  Voices zeros = Voices(numVoices, 0.0f);
+  Voices panLeft = Voices(numVoices, 1.0f);
+  Voices panRight = Voices(numVoices, 1.0f);
+  Voices peak = Voices(numVoices, 0.0f);
+  Samples left = Samples(chunkSize);
+  Samples right = Samples(chunkSize);
+};
+
+// Prints the throughput of renderChunk() in voice-samples per second, and
+// as the number of voices that would play in real time on one core
+template <typename Function>
+void report(const char *name, Function &&renderChunk) {
+  const auto seconds = Benchmarks::measureSeconds([&] {
+    for (int chunk = 0; chunk < numChunks; ++chunk)
+      renderChunk();
+  });
+
+  const auto voiceSamples = (double)numVoices * chunkSize * numChunks;
+  const auto perSecond = voiceSamples / seconds;
+  std::printf("  %-12s %9.1f M samples/s per voice %9.0f voices at 48 kHz\n",
+              name, perSecond * 1.0e-6, perSecond / sampleRate);
+}
+
+void runKernelSet(const char *name, const KernelTable &kernels) {
+  std::printf("%s (width %d)\n", name, kernels.width);
+
+  KernelInputs inputs;
+  const auto layout = inputs.layout();
+  const auto envelope = inputs.envelope();
+  const auto post = inputs.post();
+
+  report("envelope", [&] { kernels.renderEnvelope(layout, envelope); });
+
+  const std::pair<const char *, Waveform> waveforms[] = {
+      {"sine", Waveform::Sine},
+      {"saw", Waveform::Saw},
+      {"square", Waveform::Square},
+      {"saw blep", Waveform::SawBLEP},
+      {"square blep", Waveform::SquareBLEP},
+      {"table", Waveform::SawTable}};
+
+  for (const auto &[waveformName, waveform] : waveforms) {
+    const auto oscillator = inputs.oscillator(waveform, false);
+    report(waveformName,
+           [&] { kernels.renderOscillator(layout, oscillator); });
+  }
+
+  report("filter+mix", [&] { kernels.renderPost(layout, post); });
+
+  // What VoiceBank runs per chunk with both oscillators on
+  const auto oscA = inputs.oscillator(Waveform::SawBLEP, false);
+  const auto oscB = inputs.oscillator(Waveform::SquareBLEP, true);
+  report("full voice", [&] {
+    kernels.renderEnvelope(layout, envelope);
+    kernels.renderOscillator(layout, oscA);
+    kernels.renderOscillator(layout, oscB);
+    kernels.renderPost(layout, post);
+  });
+}
+
+} // namespace
+
+void Benchmarks::runKernelBenchmarks() {
+  runKernelSet("scalar", getScalarKernels());
+
+  const auto baseline = getBaselineKernels();
+  if (baseline.width > 1) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+    runKernelSet("NEON", baseline);
+#else
+    runKernelSet("SSE2", baseline);
+#endif
+  }
+
+  const auto avx = getAVXKernels();
+  if (avx.width > 0 && juce::SystemStats::hasAVX())
+    runKernelSet("AVX", avx);
+  else
+    std::printf("AVX: not available\n");
+}
@@ -0,0 +1,82 @@
+#include "Benchmarks.h"
+#include "PluginProcessor.h"
+#include <JuceHeader.h>
+
+namespace {
+
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 32;
+constexpr int numBlocks = 50000;
+
+struct MidiMode {
+  const char *name;
+  bool chordMode;
+  bool arp;
+};
+
+constexpr MidiMode midiModes[] = {
+    {"pass-through (chord mode, arp off)", false, false},
+    {"chord mode", true, false},
+    {"arp (no chord held)", false, true},
+    {"chord mode + arp", true, true},
+};
+
+void setParameter(MySynthAudioProcessor &processor, const char *id,
+                  float value) {
+  auto *parameter = processor.apvts.getParameter(id);
+  parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+// processBlock cost in microseconds per block. With notes, every block
+// starts and stops a note outside the modifier and trigger octaves, so each
+// mode passes the same notes to the same voices.
+double measureProcessBlock(MySynthAudioProcessor &processor, bool withNotes) {
+  juce::AudioBuffer<float> buffer(2, blockSize);
+  juce::MidiBuffer midi;
+  midi.ensureSize(256);
+
+  const auto seconds = Benchmarks::measureSeconds([&] {
+    for (int block = 0; block < numBlocks; ++block) {
+      midi.clear();
+      if (withNotes) {
+        const int note = 36 + block % 12;
+        midi.addEvent(juce::MidiMessage::noteOn(1, note, 1.0f), 0);
+        midi.addEvent(juce::MidiMessage::noteOff(1, note), blockSize / 2);
+      }
+      processor.processBlock(buffer, midi);
+    }
+  });
+
+  return seconds * 1.0e6 / numBlocks;
+}
+
+} // namespace
+
+void Benchmarks::runMidiLayerBenchmarks() {
+  std::printf("processBlock, %d-sample blocks at %.0f Hz\n", blockSize,
+              sampleRate);
+
+  auto processor = std::make_unique<MySynthAudioProcessor>();
+  processor->setPlayConfigDetails(0, 2, sampleRate, blockSize);
+  processor->prepareToPlay(sampleRate, blockSize);
+
+  double passThroughEmpty = 0.0;
+  double passThroughNotes = 0.0;
+  for (const auto &mode : midiModes) {
+    setParameter(*processor, "chordMode", mode.chordMode ? 1.0f : 0.0f);
+    setParameter(*processor, "arpEnabled", mode.arp ? 1.0f : 0.0f);
+
+    const auto empty = measureProcessBlock(*processor, false);
+    const auto notes = measureProcessBlock(*processor, true);
+    if (!mode.chordMode && !mode.arp) {
+      passThroughEmpty = empty;
+      passThroughNotes = notes;
+    }
+
+    std::printf("  %-36s no MIDI %7.3f us (%+.3f), notes %7.3f us (%+.3f)\n",
+                mode.name, empty, empty - passThroughEmpty, notes,
+                notes - passThroughNotes);
+  }
+
+  processor->releaseResources();
+}
@@ -0,0 +1,259 @@
+#include "Benchmarks.h"
+#include "VoiceManager.h"
+#include <JuceHeader.h>
+
+namespace {
+
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 128;
+constexpr int numVoices = VoiceBank::maxVoices;
+constexpr int numBlocks = 2000;
+constexpr int numNoteOns = 20000;
+
+// The voice the plugin used with juce::Synthesiser before VoiceManager
+// (two oscillators -> SVF low-pass -> ADSR -> gain, one voice per note),
+// trimmed to the sine waveform
+class LegacyVoice : public juce::SynthesiserVoice {
+public:
+  LegacyVoice() {
+    for (auto *osc : {&oscillatorA, &oscillatorB})
+      osc->initialise([](float x) { return std::sin(x); });
+
+    const juce::dsp::ProcessSpec spec{sampleRate, (juce::uint32)blockSize, 2};
+    tempBuffer.setSize(2, blockSize);
+    oscBBuffer.setSize(2, blockSize);
+    oscillatorA.prepare(spec);
+    oscillatorB.prepare(spec);
+    gain.prepare(spec);
+    gain.setGainLinear(0.3f);
+    filter.prepare(spec);
+    filter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
+    filter.setCutoffFrequency(20000.0f);
+
+    adsr.setSampleRate(sampleRate);
+    adsr.setParameters({0.1f, 0.1f, 1.0f, 0.4f});
+  }
+
+  bool canPlaySound(juce::SynthesiserSound *) override { return true; }
+
+  void startNote(int midiNoteNumber, float, juce::SynthesiserSound *,
+                 int) override {
+    const auto hz = juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber);
+    oscillatorA.setFrequency((float)hz, true);
+    oscillatorB.setFrequency((float)hz, true);
+    adsr.noteOn();
+  }
+
+  void stopNote(float, bool allowTailOff) override {
+    adsr.noteOff();
+    if (!allowTailOff || !adsr.isActive())
+      clearCurrentNote();
+  }
+
+  void pitchWheelMoved(int) override {}
+  void controllerMoved(int, int) override {}
+
+  void renderNextBlock(juce::AudioBuffer<float> &outputBuffer, int startSample,
+                       int numSamples) override {
+    if (!isVoiceActive())
+      return;
+
+    tempBuffer.clear();
+    oscBBuffer.clear();
+
+    juce::dsp::AudioBlock<float> blockA(tempBuffer);
+    auto subBlockA = blockA.getSubBlock(0, (size_t)numSamples);
+    juce::dsp::ProcessContextReplacing<float> contextA(subBlockA);
+
+    juce::dsp::AudioBlock<float> blockB(oscBBuffer);
+    auto subBlockB = blockB.getSubBlock(0, (size_t)numSamples);
+    juce::dsp::ProcessContextReplacing<float> contextB(subBlockB);
+
+    oscillatorA.process(contextA);
+    oscillatorB.process(contextB);
+    for (int channel = 0; channel < 2; ++channel)
+      tempBuffer.addFrom(channel, 0, oscBBuffer, channel, 0, numSamples);
+
+    filter.process(contextA);
+    adsr.applyEnvelopeToBuffer(tempBuffer, 0, numSamples);
+    gain.process(contextA);
+
+    for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
+      outputBuffer.addFrom(channel, startSample, tempBuffer, channel, 0,
+                           numSamples);
+
+    if (!adsr.isActive())
+      clearCurrentNote();
+  }
+
+private:
+  juce::dsp::Oscillator<float> oscillatorA;
+  juce::dsp::Oscillator<float> oscillatorB;
+  juce::dsp::Gain<float> gain;
+  juce::ADSR adsr;
+  juce::dsp::StateVariableTPTFilter<float> filter;
+  juce::AudioBuffer<float> tempBuffer;
+  juce::AudioBuffer<float> oscBBuffer;
+};
+
+struct LegacySound : public juce::SynthesiserSound {
+  bool appliesToNote(int) override { return true; }
+  bool appliesToChannel(int) override { return true; }
+};
+
+struct LegacyEngine {
+  LegacyEngine() {
+    for (int voice = 0; voice < numVoices; ++voice)
+      synth.addVoice(new LegacyVoice());
+    synth.addSound(new LegacySound());
+    synth.setCurrentPlaybackSampleRate(sampleRate);
+  }
+
+  void noteOn(int channel, int note) { synth.noteOn(channel, note, 1.0f); }
+  void noteOff(int channel, int note) {
+    synth.noteOff(channel, note, 0.0f, false);
+  }
+  void render(juce::AudioBuffer<float> &buffer,
+              const juce::MidiBuffer &midi) {
+    synth.renderNextBlock(buffer, midi, 0, buffer.getNumSamples());
+  }
+
+  juce::Synthesiser synth;
+};
+
+// VoiceBank and VoiceManager as the processor drives them
+struct Engine {
+  Engine() {
+    manager.prepare(sampleRate);
+    bank.setParameters(parameters);
+  }
+
+  void noteOn(int channel, int note) { manager.noteOn(channel, note); }
+  void noteOff(int channel, int note) { manager.noteOff(channel, note, false); }
+  void render(juce::AudioBuffer<float> &buffer,
+              const juce::MidiBuffer &midi) {
+    manager.renderNextBlock(buffer, midi, 0, buffer.getNumSamples());
+  }
+
+  WavetableBank wavetables;
+  WavetableLibrary library;
+  VoiceBank bank{wavetables, library};
+  VoiceManager manager{bank};
+  VoiceParameters parameters;
+};
+
+// Note-on cost in microseconds: with free voices (each note stopped right
+// away) and with every voice busy, so each note-on steals one
+template <typename EngineType> void measureNoteOns(EngineType &engine) {
+  const auto freeSeconds = Benchmarks::measureSeconds([&] {
+    for (int i = 0; i < numNoteOns; ++i) {
+      engine.noteOn(1, i % 128);
+      engine.noteOff(1, i % 128);
+    }
+  });
+
+  for (int note = 0; note < numVoices; ++note)
+    engine.noteOn(1, note);
+
+  // Alternating channels, so each note is new on its channel
+  const auto stealSeconds = Benchmarks::measureSeconds([&] {
+    for (int i = 0; i < numNoteOns; ++i)
+      engine.noteOn(1 + (i / 128) % 2, i % 128);
+  });
+
+  for (int channel = 1; channel <= 2; ++channel)
+    for (int note = 0; note < 128; ++note)
+      engine.noteOff(channel, note);
+
+  std::printf("    note-on + off, free voice  %8.3f us\n",
+              freeSeconds * 1.0e6 / numNoteOns);
+  std::printf("    note-on, stealing          %8.3f us\n",
+              stealSeconds * 1.0e6 / numNoteOns);
+}
+
+// Block cost in microseconds with no voice sounding (pure overhead) and with
+// all of them sounding
+template <typename EngineType> void measureBlocks(EngineType &engine) {
+  juce::AudioBuffer<float> buffer(2, blockSize);
+  const juce::MidiBuffer noMidi;
+
+  auto renderBlocks = [&] {
+    for (int block = 0; block < numBlocks; ++block)
+      engine.render(buffer, noMidi);
+  };
+
+  const auto idleSeconds = Benchmarks::measureSeconds(renderBlocks);
+
+  for (int note = 0; note < numVoices; ++note)
+    engine.noteOn(1, note);
+  const auto busySeconds = Benchmarks::measureSeconds(renderBlocks);
+  for (int note = 0; note < numVoices; ++note)
+    engine.noteOff(1, note);
+
+  std::printf("    block, idle                %8.3f us\n",
+              idleSeconds * 1.0e6 / numBlocks);
+  std::printf("    block, %3d voices          %8.3f us (%.3f us per voice)\n",
+              numVoices, busySeconds * 1.0e6 / numBlocks,
+              busySeconds * 1.0e6 / numBlocks / numVoices);
+}
+
+template <typename EngineType> void runEngine(const char *name) {
+  auto engine = std::make_unique<EngineType>();
+
+  std::printf("  %s\n", name);
+  measureNoteOns(*engine);
+  measureBlocks(*engine);
+}
+
+// Block cost in microseconds with numChords chords of chordSize notes held,
+// each chord struck at its own sample so it gets its own voice(s)
+double measureChords(Engine &engine, bool chordVoices, int numChords,
+                     int chordSize) {
+  engine.manager.setChordVoices(chordVoices);
+  engine.manager.allNotesOff(0, false);
+
+  juce::AudioBuffer<float> buffer(2, blockSize);
+  juce::MidiBuffer chords;
+  for (int chord = 0; chord < numChords; ++chord)
+    for (int note = 0; note < chordSize; ++note)
+      chords.addEvent(juce::MidiMessage::noteOn(1, 24 + chord * 12 + note,
+                                                1.0f),
+                      chord);
+  engine.render(buffer, chords);
+
+  const juce::MidiBuffer noMidi;
+  const auto seconds = Benchmarks::measureSeconds([&] {
+    for (int block = 0; block < numBlocks; ++block)
+      engine.render(buffer, noMidi);
+  });
+
+  engine.manager.allNotesOff(0, false);
+  return seconds * 1.0e6 / numBlocks;
+}
+
+} // namespace
+
+void Benchmarks::runVoiceManagerBenchmarks() {
+  std::printf("%d voices, %d-sample blocks at %.0f Hz\n", numVoices,
+              blockSize, sampleRate);
+
+  runEngine<LegacyEngine>("juce::Synthesiser (old path)");
+  runEngine<Engine>("VoiceManager + VoiceBank");
+}
+
+void Benchmarks::runChordVoiceBenchmarks() {
+  constexpr int numChords = 8;
+  std::printf("%d chords held, %d-sample blocks at %.0f Hz\n", numChords,
+              blockSize, sampleRate);
+
+  auto engine = std::make_unique<Engine>();
+
+  for (int chordSize : {3, 6, 12}) {
+    const auto perNote = measureChords(*engine, false, numChords, chordSize);
+    const auto perChord = measureChords(*engine, true, numChords, chordSize);
+
+    std::printf("  %2d-note chords: voice per note %8.3f us/block, chord "
+                "voices %8.3f us/block (%.2fx)\n",
+                chordSize, perNote, perChord, perNote / perChord);
+  }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+
+// Places arpeggiator steps on the timeline. Positions are 64-bit fixed point
+// quarter notes, and step k starts exactly at k step lengths, so step times
+// never accumulate error.
+//
+// While the host transport runs, each block's position comes straight from
+// its PPQ position. Otherwise a free-running clock counts samples since the
+// last tempo change (or host position) and derives the position from that
+// count, never from a running sum of block lengths.
+//
+// A step plays at the first sample at or after its start. A fresh
+// free-running clock skips the step at its origin, so the arp's first step
+// sounds one step length after it starts.
+class ArpScheduler {
+public:
+  static constexpr std::int64_t ticksPerQuarter = std::int64_t{1} << 32;
+
+  // Restarts the free-running clock at zero
+  void reset() {
+    freeRunOrigin = 0;
+    freeRunSamples = 0;
+    freeRunTicksPerSample = 0.0;
+    nextStep = 0;
+    isFreeRunStart = true;
+  }
+
+  // Calls onStep(sampleOffset) for each step starting in the block, in
+  // order. hostPpq is the host position at the block start, or empty when
+  // the transport is stopped.
+  template <typename Function>
+  void process(std::optional<double> hostPpq, double bpm, double sampleRate,
+               std::int64_t stepTicks, int numSamples, Function &&onStep) {
+    const double ticksPerSample =
+        (double)ticksPerQuarter * bpm / (60.0 * sampleRate);
+
+    std::int64_t blockStart;
+    if (hostPpq.has_value()) {
+      blockStart = std::llround(*hostPpq * (double)ticksPerQuarter);
+      // The free clock picks up from here if the transport stops
+      freeRunOrigin = blockStart;
+      freeRunSamples = 0;
+    } else {
+      // A tempo change restarts the count from the current position
+      if (std::islessgreater(ticksPerSample, freeRunTicksPerSample)) {
+        freeRunOrigin += std::llround((double)freeRunSamples *
+                                      freeRunTicksPerSample);
+        freeRunSamples = 0;
+      }
+      blockStart = freeRunOrigin +
+                   std::llround((double)freeRunSamples * ticksPerSample);
+    }
+    freeRunTicksPerSample = ticksPerSample;
+    freeRunSamples += numSamples;
+
+    // First step starting at or after the block start, unless the last
+    // block's next step started in the gap before its first sample
+    std::int64_t step = ceilDiv(blockStart, stepTicks);
+    if (nextStep == step - 1 &&
+        (double)(blockStart - nextStep * stepTicks) < ticksPerSample)
+      step = nextStep;
+
+    // Step 0 of a fresh free-running clock counts as already played
+    if (isFreeRunStart && !hostPpq.has_value() && step == 0)
+      step = 1;
+    isFreeRunStart = false;
+
+    for (;; ++step) {
+      const double offset =
+          std::ceil((double)(step * stepTicks - blockStart) / ticksPerSample -
+                    onSampleTolerance);
+      if (offset >= numSamples)
+        break;
+
+      onStep(offset > 0.0 ? (int)offset : 0);
+    }
+
+    nextStep = step;
+  }
+
+private:
+  // Positions are rounded to whole ticks, so a step starting this close
+  // after a sample (in samples) counts as starting on it
+  static constexpr double onSampleTolerance = 1.0e-4;
+
+  static std::int64_t ceilDiv(std::int64_t value, std::int64_t divisor) {
+    return value >= 0 ? (value + divisor - 1) / divisor : -(-value / divisor);
+  }
+
+  std::int64_t freeRunOrigin{0};
+  std::int64_t freeRunSamples{0};
+  double freeRunTicksPerSample{0.0};
+  std::int64_t nextStep{0};
+  bool isFreeRunStart{true};
+};
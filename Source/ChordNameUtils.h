@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ChordTables.h"
 #include <JuceHeader.h>
 
 namespace ChordNameUtils {
@@ -71,4 +72,39 @@ inline juce::String getChordName(int rootNote, bool isDim, bool isMin,
   return name;
 }
 
+// Every name getChordName() can return, built once so that showing the
+// current chord is a lookup rather than string building
+class ChordNameTable {
+public:
+  ChordNameTable() {
+    using namespace ChordTables;
+    constexpr int triadKeys[numTriads] = {0, dimKey, minKey, majKey, sus2Key};
+    constexpr int extensionKeys[numExtensions] = {0, sixKey, min7Key, maj7Key,
+                                                  nineKey};
+
+    for (int root = 0; root < 12; ++root) {
+      for (int shape = 0; shape < numShapes; ++shape) {
+        const int mask = triadKeys[shape / numExtensions] |
+                         extensionKeys[shape % numExtensions];
+        names[(size_t)root][(size_t)shape] = getChordName(
+            root, mask & dimKey, mask & minKey, mask & majKey, mask & sus2Key,
+            mask & sixKey, mask & min7Key, mask & maj7Key, mask & nineKey);
+      }
+    }
+  }
+
+  // Empty when no chord has played (rootNote < 0)
+  const juce::String &get(int rootNote, int modifierMask) const {
+    if (rootNote < 0)
+      return noChord;
+
+    const int shape = ChordTables::shapeOfMask[(size_t)(modifierMask & 0xff)];
+    return names[(size_t)(rootNote % 12)][(size_t)shape];
+  }
+
+private:
+  std::array<std::array<juce::String, ChordTables::numShapes>, 12> names;
+  juce::String noChord;
+};
+
 } // namespace ChordNameUtils
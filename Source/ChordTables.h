@@ -0,0 +1,186 @@
+#pragma once
+
+#include "NoteSet.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Chord generation as table lookups. The held modifier keys form an 8-bit
+// mask; every mask maps to one of the 25 chord shapes (triad x extension)
+// through a table built at compile time. The notes a shape plays for each
+// root pitch class depend only on the note range, so they are cached per
+// range (as NoteSets) and rebuilt when the range changes.
+namespace ChordTables {
+
+// One bit per modifier key
+enum Modifier : std::uint8_t {
+  dimKey = 1 << 0,  // C#2
+  minKey = 1 << 1,  // D#2
+  majKey = 1 << 2,  // F#2
+  sus2Key = 1 << 3, // G#2
+  sixKey = 1 << 4,  // C4
+  min7Key = 1 << 5, // D4
+  maj7Key = 1 << 6, // F4
+  nineKey = 1 << 7  // G4
+};
+
+// The modifier a key in the modifier octave (60-71) sets, or 0
+constexpr int getModifierForNote(int noteNumber) {
+  switch (noteNumber) {
+  case 60:
+    return sixKey;
+  case 61:
+    return dimKey;
+  case 62:
+    return min7Key;
+  case 63:
+    return minKey;
+  case 65:
+    return maj7Key;
+  case 66:
+    return majKey;
+  case 67:
+    return nineKey;
+  case 68:
+    return sus2Key;
+  default:
+    return 0;
+  }
+}
+
+constexpr int numModifierMasks = 256;
+constexpr int numTriads = 5;     // None, dim, min, maj, sus2
+constexpr int numExtensions = 5; // None, 6, min7, maj7, 9
+constexpr int numShapes = numTriads * numExtensions;
+constexpr int maxIntervals = 4;
+
+struct Intervals {
+  std::array<int, maxIntervals> values{};
+  int size{0};
+};
+
+// Lowest key wins within each group:
+// triad dim > min > maj > sus2, extension 6 > min7 > maj7 > 9
+constexpr int getShape(int modifierMask) {
+  int triad = 0;
+  if (modifierMask & dimKey)
+    triad = 1;
+  else if (modifierMask & minKey)
+    triad = 2;
+  else if (modifierMask & majKey)
+    triad = 3;
+  else if (modifierMask & sus2Key)
+    triad = 4;
+
+  int extension = 0;
+  if (modifierMask & sixKey)
+    extension = 1;
+  else if (modifierMask & min7Key)
+    extension = 2;
+  else if (modifierMask & maj7Key)
+    extension = 3;
+  else if (modifierMask & nineKey)
+    extension = 4;
+
+  return triad * numExtensions + extension;
+}
+
+// Intervals above the root, triad first
+constexpr Intervals getShapeIntervals(int shape) {
+  constexpr int triads[numTriads][2] = {
+      {0, 0}, // Root only
+      {3, 6}, // Minor third, diminished fifth
+      {3, 7}, // Minor third, perfect fifth
+      {4, 7}, // Major third, perfect fifth
+      {2, 7}  // Major second, perfect fifth
+  };
+  constexpr int extensions[numExtensions][2] = {
+      {0, 0},  // None
+      {9, 0},  // Major sixth
+      {10, 0}, // Minor seventh
+      {11, 0}, // Major seventh
+      {10, 14} // Minor seventh, major ninth
+  };
+  constexpr int triadSizes[numTriads] = {0, 2, 2, 2, 2};
+  constexpr int extensionSizes[numExtensions] = {0, 1, 1, 1, 2};
+
+  const int triad = shape / numExtensions;
+  const int extension = shape % numExtensions;
+
+  Intervals intervals;
+  for (int i = 0; i < triadSizes[triad]; ++i)
+    intervals.values[(size_t)intervals.size++] = triads[triad][i];
+  for (int i = 0; i < extensionSizes[extension]; ++i)
+    intervals.values[(size_t)intervals.size++] = extensions[extension][i];
+  return intervals;
+}
+
+inline constexpr auto shapeOfMask = [] {
+  std::array<std::uint8_t, numModifierMasks> table{};
+  for (int mask = 0; mask < numModifierMasks; ++mask)
+    table[(size_t)mask] = static_cast<std::uint8_t>(getShape(mask));
+  return table;
+}();
+
+inline constexpr auto shapeIntervals = [] {
+  std::array<Intervals, numShapes> table{};
+  for (int shape = 0; shape < numShapes; ++shape)
+    table[(size_t)shape] = getShapeIntervals(shape);
+  return table;
+}();
+
+// Chord notes for every shape and root pitch class within one note range:
+// every note in [low, high] sharing a pitch class with the root or one of
+// the intervals.
+class ChordCache {
+public:
+  ChordCache() { build(); }
+
+  // Rebuilds the cache when the range differs from the one it holds
+  void setRange(int newLowNote, int newHighNote) {
+    if (newLowNote == lowNote && newHighNote == highNote)
+      return;
+
+    lowNote = newLowNote;
+    highNote = newHighNote;
+    build();
+  }
+
+  NoteSet getNotes(int modifierMask, int rootNote) const {
+    return chords[(size_t)shapeOfMask[(size_t)(modifierMask & 0xff)]]
+                 [(size_t)(rootNote % 12)];
+  }
+
+private:
+  void build() {
+    for (int shape = 0; shape < numShapes; ++shape) {
+      const auto &intervals = shapeIntervals[(size_t)shape];
+
+      for (int root = 0; root < 12; ++root) {
+        auto &chord = chords[(size_t)shape][(size_t)root];
+        chord.clear();
+
+        auto addPitchClass = [&](int baseNote) {
+          // First note of the pitch class at or above lowNote
+          const int offset = ((baseNote - lowNote) % 12 + 12) % 12;
+
+          for (int note = lowNote + offset;
+               note <= highNote && note < NoteSet::numNotes; note += 12) {
+            if (note >= 0)
+              chord.add(note);
+          }
+        };
+
+        addPitchClass(root);
+        for (int i = 0; i < intervals.size; ++i)
+          addPitchClass(root + intervals.values[(size_t)i]);
+      }
+    }
+  }
+
+  int lowNote{48};
+  int highNote{84};
+  std::array<std::array<NoteSet, 12>, numShapes> chords{};
+};
+
+} // namespace ChordTables
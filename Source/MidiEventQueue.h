@@ -0,0 +1,151 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+// Short MIDI messages in time order, in fixed storage. The chord and arp
+// stages write their events in time order, so adding one is an append: no
+// search, no memmove and never an allocation, unlike juce::MidiBuffer. An
+// event earlier than the last one is still inserted in place. Long messages
+// (SysEx) do not fit; the voices ignore them anyway.
+//
+// A full queue drops events rather than allocate. The last slots are kept
+// for events that end notes, so a flood of note-ons cannot push out the
+// note-offs for them; if even those run out, the channels that lost one are
+// recorded for the caller to silence.
+class MidiEventQueue {
+public:
+  struct Event {
+    int samplePosition;
+    std::array<std::uint8_t, 3> bytes;
+    std::uint8_t numBytes;
+    bool legato; // Part of a chord change; see VoiceManager
+
+    // Short messages are stored inline, so this never allocates
+    juce::MidiMessage getMessage() const {
+      return {bytes.data(), (int)numBytes, (double)samplePosition};
+    }
+  };
+
+  // Enough for a block of dense host input with a chord change at every event
+  static constexpr int capacity = 4096;
+  // Slots only note-offs (and pedal up, all notes off) may take: a whole
+  // chord's release fits twice over
+  static constexpr int releaseReserve = 256;
+
+  void clear() {
+    numEvents = 0;
+    droppedReleaseChannels = 0;
+  }
+  bool isEmpty() const { return numEvents == 0; }
+  int size() const { return numEvents; }
+
+  const Event *begin() const { return events.data(); }
+  const Event *end() const { return events.data() + numEvents; }
+
+  // One bit per MIDI channel (bit 0 = channel 1) that lost an event ending
+  // notes since the last clear(); those notes would otherwise hang
+  std::uint16_t getDroppedReleaseChannels() const {
+    return droppedReleaseChannels;
+  }
+
+  // Events at the same position keep the order they were added in
+  void add(const std::uint8_t *data, int numBytes, int samplePosition,
+           bool legato = false) {
+    if (numBytes <= 0 || numBytes > 3)
+      return;
+
+    Event event{samplePosition, {}, (std::uint8_t)numBytes, legato};
+    std::copy(data, data + numBytes, event.bytes.begin());
+    insert(event);
+  }
+
+  void add(const juce::MidiMessage &message, int samplePosition,
+           bool legato = false) {
+    add(message.getRawData(), message.getRawDataSize(), samplePosition,
+        legato);
+  }
+
+  void addNoteOn(int channel, int note, float velocity, int samplePosition,
+                 bool legato = false) {
+    add(juce::MidiMessage::noteOn(channel, note, velocity), samplePosition,
+        legato);
+  }
+  void addNoteOff(int channel, int note, float velocity, int samplePosition,
+                  bool legato = false) {
+    add(juce::MidiMessage::noteOff(channel, note, velocity), samplePosition,
+        legato);
+  }
+
+  // Refills this queue with input and generated merged in one linear pass.
+  // At the same position, input events come first. Input is a MidiBuffer or
+  // another queue; long messages in it are skipped.
+  template <typename Events>
+  void merge(const Events &input, const MidiEventQueue &generated) {
+    clear();
+
+    auto next = generated.begin();
+    for (const auto &event : input) {
+      for (; next != generated.end() &&
+             next->samplePosition < event.samplePosition;
+           ++next)
+        insert(*next);
+
+      if (event.numBytes <= 3)
+        insert(toEvent(event));
+    }
+
+    for (; next != generated.end(); ++next)
+      insert(*next);
+  }
+
+private:
+  static const Event &toEvent(const Event &event) { return event; }
+  static Event toEvent(const juce::MidiMessageMetadata &metadata) {
+    Event event{metadata.samplePosition, {}, (std::uint8_t)metadata.numBytes,
+                false};
+    std::copy(metadata.data, metadata.data + metadata.numBytes,
+              event.bytes.begin());
+    return event;
+  }
+
+  // Note-off, note-on at velocity 0, sustain pedal up, all sound/notes off
+  static bool endsNotes(const Event &event) {
+    const auto status = event.bytes[0] & 0xf0;
+    const auto data1 = event.bytes[1];
+    const auto data2 = event.bytes[2];
+    return status == 0x80 || (status == 0x90 && data2 == 0) ||
+           (status == 0xb0 &&
+            ((data1 == 64 && data2 < 64) || data1 == 120 || data1 == 123));
+  }
+
+  void insert(const Event &event) {
+    // Full: drop the event rather than allocate on the audio thread
+    const bool isRelease = event.numBytes == 3 && endsNotes(event);
+    if (numEvents >= capacity - (isRelease ? 0 : releaseReserve)) {
+      jassertfalse;
+      if (isRelease)
+        droppedReleaseChannels |= (std::uint16_t)(1 << (event.bytes[0] & 0x0f));
+      return;
+    }
+
+    auto *last = events.data() + numEvents++;
+    if (last == events.data() ||
+        (last - 1)->samplePosition <= event.samplePosition) {
+      *last = event;
+      return;
+    }
+
+    auto *position = std::upper_bound(
+        events.data(), last, event.samplePosition,
+        [](int time, const Event &e) { return time < e.samplePosition; });
+    std::move_backward(position, last, last + 1);
+    *position = event;
+  }
+
+  std::array<Event, capacity> events;
+  int numEvents{0};
+  std::uint16_t droppedReleaseChannels{0};
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// A set of MIDI notes (0-127) as a 128-bit mask. Set operations are a couple
+// of word ops and iteration is a bit scan, in ascending note order; nothing
+// allocates.
+class NoteSet {
+public:
+  static constexpr int numNotes = 128;
+
+  constexpr void add(int note) { words[index(note)] |= bit(note); }
+  constexpr void remove(int note) { words[index(note)] &= ~bit(note); }
+  constexpr bool contains(int note) const {
+    return (words[index(note)] & bit(note)) != 0;
+  }
+
+  constexpr void clear() { words = {}; }
+  constexpr bool isEmpty() const { return (words[0] | words[1]) == 0; }
+  constexpr int size() const {
+    return std::popcount(words[0]) + std::popcount(words[1]);
+  }
+
+  // Notes in this set and not in other
+  constexpr NoteSet without(const NoteSet &other) const {
+    return {words[0] & ~other.words[0], words[1] & ~other.words[1]};
+  }
+  constexpr NoteSet operator|(const NoteSet &other) const {
+    return {words[0] | other.words[0], words[1] | other.words[1]};
+  }
+  constexpr NoteSet operator&(const NoteSet &other) const {
+    return {words[0] & other.words[0], words[1] & other.words[1]};
+  }
+  constexpr NoteSet operator^(const NoteSet &other) const {
+    return {words[0] ^ other.words[0], words[1] ^ other.words[1]};
+  }
+  constexpr bool operator==(const NoteSet &other) const = default;
+
+  // Calls function(note) for every note, lowest first
+  template <typename Function>
+  constexpr void forEach(Function &&function) const {
+    for (int word = 0; word < numWords; ++word) {
+      for (auto bits = words[(size_t)word]; bits != 0; bits &= bits - 1)
+        function(word * 64 + std::countr_zero(bits));
+    }
+  }
+
+  constexpr NoteSet() = default;
+
+private:
+  static constexpr int numWords = numNotes / 64;
+
+  constexpr NoteSet(std::uint64_t low, std::uint64_t high) : words{low, high} {}
+
+  static constexpr size_t index(int note) { return (size_t)(note >> 6); }
+  static constexpr std::uint64_t bit(int note) {
+    return std::uint64_t{1} << (note & 63);
+  }
+
+  std::array<std::uint64_t, numWords> words{};
+};
@@ -10,7 +10,7 @@ constexpr int MIN_GAP = 11;
 MySynthAudioProcessorEditor::MySynthAudioProcessorEditor(
     MySynthAudioProcessor &p)
     : AudioProcessorEditor(&p), audioProcessor(p) {
-  setSize(540, 600);
+  setSize(540, 735);
   setLookAndFeel(&myLookAndFeel);
 
   startTimerHz(60); // Start repainting at 60fps for visualizer
@@ -30,7 +30,7 @@ MySynthAudioProcessorEditor::MySynthAudioProcessorEditor(
   auto setupOscUI = [this, setupToggleButton](
                         OscillatorUI &ui, juce::String enabledId,
                         juce::String levelId, juce::String rangeId,
-                        juce::String typeId) {
+                        juce::String typeId, juce::String tableId) {
     // Enabled
     setupToggleButton(ui.enabledButton);
     ui.enabledAttachment =
@@ -66,18 +66,35 @@ MySynthAudioProcessorEditor::MySynthAudioProcessorEditor(
     ui.typeSelector.addItem("Sine", 1);
     ui.typeSelector.addItem("Saw", 2);
     ui.typeSelector.addItem("Square", 3);
+    ui.typeSelector.addItem("Saw BL", 4);
+    ui.typeSelector.addItem("Square BL", 5);
+    ui.typeSelector.addItem("Saw WT", 6);
+    ui.typeSelector.addItem("Square WT", 7);
+    ui.typeSelector.addItem("User", 8);
     addAndMakeVisible(ui.typeSelector);
 
     ui.typeAttachment = std::make_unique<
         juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
         audioProcessor.apvts, typeId, ui.typeSelector);
+
+    // Table Knob (picks the "User" table; shows the index while dragging)
+    ui.tableSlider.setSliderStyle(
+        juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+    ui.tableSlider.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
+    ui.tableSlider.setPopupDisplayEnabled(true, false, this);
+    addAndMakeVisible(ui.tableSlider);
+    ui.tableAttachment =
+        std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+            audioProcessor.apvts, tableId, ui.tableSlider);
   };
 
   // Initialize Osc A
-  setupOscUI(oscAUI, "oscEnabled", "oscLevel", "oscRange", "oscType");
+  setupOscUI(oscAUI, "oscEnabled", "oscLevel", "oscRange", "oscType",
+             "oscTable");
 
   // Initialize Osc B
-  setupOscUI(oscBUI, "oscBEnabled", "oscBLevel", "oscBRange", "oscBType");
+  setupOscUI(oscBUI, "oscBEnabled", "oscBLevel", "oscBRange", "oscBType",
+             "oscBTable");
 
   // Attack Slider
   attackSlider.setSliderStyle(juce::Slider::SliderStyle::LinearVertical);
@@ -115,6 +132,12 @@ MySynthAudioProcessorEditor::MySynthAudioProcessorEditor(
       std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
           audioProcessor.apvts, "release", releaseSlider);
 
+  // Envelope Curve (off: linear, on: exponential)
+  setupToggleButton(envCurveButton);
+  envCurveAttachment =
+      std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+          audioProcessor.apvts, "envCurve", envCurveButton);
+
   // Arp Enabled
   setupToggleButton(arpEnabledButton);
   arpEnabledAttachment =
@@ -153,6 +176,38 @@ MySynthAudioProcessorEditor::MySynthAudioProcessorEditor(
       std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
           audioProcessor.apvts, "retriggerMode", retriggerButton);
 
+  // Polyphony
+  polyphonySlider.setSliderStyle(
+      juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+  polyphonySlider.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
+  addAndMakeVisible(polyphonySlider);
+
+  polyphonyAttachment =
+      std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+          audioProcessor.apvts, "polyphony", polyphonySlider);
+
+  // Stereo Spread
+  spreadSlider.setSliderStyle(
+      juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+  spreadSlider.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
+  addAndMakeVisible(spreadSlider);
+
+  spreadAttachment =
+      std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+          audioProcessor.apvts, "spread", spreadSlider);
+
+  // Chord Glide Button
+  setupToggleButton(chordGlideButton);
+  chordGlideAttachment =
+      std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+          audioProcessor.apvts, "chordGlide", chordGlideButton);
+
+  // Chord Voice Button
+  setupToggleButton(chordVoiceButton);
+  chordVoiceAttachment =
+      std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+          audioProcessor.apvts, "chordVoice", chordVoiceButton);
+
   // Filter Enabled
   setupToggleButton(filterEnabledButton);
   filterEnabledAttachment =
@@ -293,24 +348,22 @@ void MySynthAudioProcessorEditor::timerCallback() {
   updateRangeVisuals(oscAUI, "oscRange");
   updateRangeVisuals(oscBUI, "oscBRange");
 
-  // Update Modifier States
-  dimButton.setToggleState(audioProcessor.isDimPressedVal(),
-                           juce::dontSendNotification);
-  minButton.setToggleState(audioProcessor.isMinPressedVal(),
-                           juce::dontSendNotification);
-  majButton.setToggleState(audioProcessor.isMajPressedVal(),
-                           juce::dontSendNotification);
-  sus2Button.setToggleState(audioProcessor.isSus2PressedVal(),
-                            juce::dontSendNotification);
-
-  sixthButton.setToggleState(audioProcessor.is6PressedVal(),
-                             juce::dontSendNotification);
-  min7Button.setToggleState(audioProcessor.isMin7PressedVal(),
-                            juce::dontSendNotification);
-  maj7Button.setToggleState(audioProcessor.isMaj7PressedVal(),
-                            juce::dontSendNotification);
-  ninthButton.setToggleState(audioProcessor.is9PressedVal(),
-                             juce::dontSendNotification);
+  // Update Modifier States (one snapshot for all of them)
+  const int modifiers = audioProcessor.getChordState().modifierMask;
+  auto showModifier = [modifiers](juce::Button &button, int modifier) {
+    button.setToggleState((modifiers & modifier) != 0,
+                          juce::dontSendNotification);
+  };
+
+  showModifier(dimButton, ChordTables::dimKey);
+  showModifier(minButton, ChordTables::minKey);
+  showModifier(majButton, ChordTables::majKey);
+  showModifier(sus2Button, ChordTables::sus2Key);
+
+  showModifier(sixthButton, ChordTables::sixKey);
+  showModifier(min7Button, ChordTables::min7Key);
+  showModifier(maj7Button, ChordTables::maj7Key);
+  showModifier(ninthButton, ChordTables::nineKey);
 
   // Arpeggiator Visualization Updates
   // 1. Read new notes from FIFO
@@ -346,7 +399,7 @@ void MySynthAudioProcessorEditor::paint(juce::Graphics &g) {
 
   auto area = getLocalBounds();
   const auto pianoHeight = 60;
-  const auto moduleHeight = (area.getHeight() - pianoHeight) / 4;
+  const auto moduleHeight = (area.getHeight() - pianoHeight) / 5;
   const auto moduleWidth = area.getWidth() / 2;
 
   g.fillAll(backgroundColor);
@@ -371,6 +424,11 @@ void MySynthAudioProcessorEditor::paint(juce::Graphics &g) {
   g.drawRect(filterArea, 1.0f);
   g.drawRect(envelopeArea, 1.0f);
 
+  // Voices
+  auto voicesArea = area.removeFromTop(moduleHeight);
+
+  g.drawRect(voicesArea, 1.0f);
+
   // Piano
   auto pianoArea = area.removeFromTop(pianoHeight);
 
@@ -506,6 +564,12 @@ void MySynthAudioProcessorEditor::paint(juce::Graphics &g) {
   g.drawFittedText("Res", resLabel, juce::Justification::centred, 1);
   g.drawFittedText("Env", envLabel, juce::Justification::centred, 1);
 
+  // Envelope Labels
+  // Layout: Curve (50px) | A | D | S | R
+  auto curveRect = envelopeArea.removeFromLeft(50).reduced(5);
+  g.drawFittedText("Exp", curveRect.removeFromTop(20),
+                   juce::Justification::centred, 1);
+
   const auto sliderWidth = envelopeArea.getWidth() / 4;
 
   auto attackRect = envelopeArea.removeFromLeft(sliderWidth).reduced(5);
@@ -522,6 +586,33 @@ void MySynthAudioProcessorEditor::paint(juce::Graphics &g) {
   g.drawFittedText("R", releaseRect.removeFromTop(20),
                    juce::Justification::centred, 1);
 
+  // Voices Labels
+  // Layout: Polyphony | Spread | Glide | Chord Voice
+  auto voicesLabelArea = voicesArea.removeFromTop(40).reduced(5);
+  g.drawFittedText("Voices", voicesLabelArea, juce::Justification::left, 1);
+
+  const auto voiceColumnWidth = voicesArea.getWidth() / 4;
+
+  auto polyphonyLabel = voicesArea.removeFromLeft(voiceColumnWidth)
+                            .removeFromTop(20)
+                            .reduced(5, 0);
+  auto spreadLabel = voicesArea.removeFromLeft(voiceColumnWidth)
+                         .removeFromTop(20)
+                         .reduced(5, 0);
+  auto glideLabel = voicesArea.removeFromLeft(voiceColumnWidth)
+                        .removeFromTop(20)
+                        .reduced(5, 0);
+  auto chordVoiceLabel = voicesArea.removeFromLeft(voiceColumnWidth)
+                             .removeFromTop(20)
+                             .reduced(5, 0);
+
+  g.drawFittedText("Polyphony", polyphonyLabel, juce::Justification::centred,
+                   1);
+  g.drawFittedText("Spread", spreadLabel, juce::Justification::centred, 1);
+  g.drawFittedText("Glide", glideLabel, juce::Justification::centred, 1);
+  g.drawFittedText("Chord Voice", chordVoiceLabel,
+                   juce::Justification::centred, 1);
+
   // Piano Area Labels (optional)
   // Maybe draw "Limit" labels near the sliders if needed, or just let sliders
   // handle it. The user didn't explicitly ask for labels in Piano Area, but
@@ -587,7 +678,7 @@ void MySynthAudioProcessorEditor::resized() {
   const auto padding = 10;
 
   const auto pianoHeight = 60;
-  const auto moduleHeight = (bounds.getHeight() - pianoHeight) / 4;
+  const auto moduleHeight = (bounds.getHeight() - pianoHeight) / 5;
   const auto moduleWidth = bounds.getWidth() / 2;
 
   auto area = bounds;
@@ -598,6 +689,7 @@ void MySynthAudioProcessorEditor::resized() {
   auto filterAndEnvelopeArea = area.removeFromTop(moduleHeight);
   auto filterArea = filterAndEnvelopeArea.removeFromLeft(moduleWidth);
   auto envelopeArea = filterAndEnvelopeArea.removeFromRight(moduleWidth);
+  auto voicesArea = area.removeFromTop(moduleHeight);
   auto pianoArea = area.removeFromTop(pianoHeight);
   auto chordsArea = area.removeFromTop(moduleHeight);
   auto chordsButtonsArea = chordsArea.removeFromLeft(moduleWidth);
@@ -635,14 +727,21 @@ void MySynthAudioProcessorEditor::resized() {
     rangeGroup.removeFromLeft(rangeBtnGap);
     ui.range4Button.setBounds(rangeGroup.removeFromLeft(rangeBtnSize));
 
-    // Bottom: Type Selector
-    ui.typeSelector.setBounds(
-        centerArea.removeFromTop(30).withSizeKeepingCentre(140, 30));
+    // Bottom: Type Selector and Table Knob
+    auto typeArea = centerArea.removeFromTop(30).withSizeKeepingCentre(140, 30);
+    ui.tableSlider.setBounds(typeArea.removeFromRight(30));
+    typeArea.removeFromRight(5);
+    ui.typeSelector.setBounds(typeArea);
   };
 
   layoutOscUI(oscAUI, oscAArea);
   layoutOscUI(oscBUI, oscBArea);
 
+  // Left: Curve Toggle
+  auto envCurveArea = envelopeArea.removeFromLeft(50);
+  envCurveArea.removeFromTop(20); // Label
+  envCurveButton.setBounds(envCurveArea.withSizeKeepingCentre(30, 30));
+
   // Sliders area
   const auto sliderWidth = envelopeArea.getWidth() / 4;
 
@@ -690,6 +789,27 @@ void MySynthAudioProcessorEditor::resized() {
   envArea.removeFromTop(20);
   filterEnvSlider.setBounds(envArea.reduced(padding));
 
+  // Voices Area
+  // Below the label, one column per control, each with its label on top
+  voicesArea.removeFromTop(40);
+  const auto voiceColumnWidth = voicesArea.getWidth() / 4;
+
+  auto polyphonyArea = voicesArea.removeFromLeft(voiceColumnWidth);
+  polyphonyArea.removeFromTop(20); // Label
+  polyphonySlider.setBounds(polyphonyArea.withSizeKeepingCentre(60, 60));
+
+  auto spreadArea = voicesArea.removeFromLeft(voiceColumnWidth);
+  spreadArea.removeFromTop(20);
+  spreadSlider.setBounds(spreadArea.withSizeKeepingCentre(60, 60));
+
+  auto chordGlideArea = voicesArea.removeFromLeft(voiceColumnWidth);
+  chordGlideArea.removeFromTop(20);
+  chordGlideButton.setBounds(chordGlideArea.withSizeKeepingCentre(30, 30));
+
+  auto chordVoiceArea = voicesArea.removeFromLeft(voiceColumnWidth);
+  chordVoiceArea.removeFromTop(20);
+  chordVoiceButton.setBounds(chordVoiceArea.withSizeKeepingCentre(30, 30));
+
   // Piano Area Limits
   auto shiftControlArea = pianoArea.removeFromRight(68);
   rangeShiftSlider.setBounds(shiftControlArea.reduced(5));
@@ -49,6 +49,10 @@ private:
   std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>
       releaseAttachment;
 
+  juce::TextButton envCurveButton;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>
+      envCurveAttachment;
+
   struct OscillatorUI {
     juce::TextButton enabledButton{"On"};
     juce::TextButton range16Button{"16"};
@@ -56,6 +60,7 @@ private:
     juce::TextButton range4Button{"4"};
     juce::Slider levelSlider;
     juce::ComboBox typeSelector;
+    juce::Slider tableSlider; // User wavetable index
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>
         enabledAttachment;
@@ -63,6 +68,8 @@ private:
         levelAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>
         typeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>
+        tableAttachment;
   };
 
   OscillatorUI oscAUI;
@@ -85,6 +92,23 @@ private:
   std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>
       retriggerAttachment;
 
+  // Voices UI
+  juce::Slider polyphonySlider;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>
+      polyphonyAttachment;
+
+  juce::Slider spreadSlider;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>
+      spreadAttachment;
+
+  juce::TextButton chordGlideButton;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>
+      chordGlideAttachment;
+
+  juce::TextButton chordVoiceButton;
+  std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>
+      chordVoiceAttachment;
+
   // Modifier Buttons (Indicators)
   juce::TextButton dimButton{"Dim"};
   juce::TextButton minButton{"Min"};
@@ -1,6 +1,6 @@
 #include "PluginProcessor.h"
-#include "ChordNameUtils.h"
 #include "PluginEditor.h"
+#include "RealtimeAllocationDetector.h"
 
 MySynthAudioProcessor::MySynthAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -15,26 +15,21 @@ MySynthAudioProcessor::MySynthAudioProcessor()
       )
 #endif
 {
-  // Add voices
-  for (int i = 0; i < 8; ++i)
-    synthesiser.addVoice(new SynthVoice());
-
-  // Add a sound (required for the synthesiser to work)
-  synthesiser.addSound(new SynthSound());
-
   // Cache parameters
   attackParam = apvts.getRawParameterValue("attack");
   releaseParam = apvts.getRawParameterValue("release");
   oscTypeParam = apvts.getRawParameterValue("oscType");
   decayParam = apvts.getRawParameterValue("decay");
   sustainParam = apvts.getRawParameterValue("sustain");
-  cutoffParam = apvts.getRawParameterValue("cutoff");
+  envCurveParam = apvts.getRawParameterValue("envCurve");
   cutoffParam = apvts.getRawParameterValue("cutoff");
   resonanceParam = apvts.getRawParameterValue("resonance");
   filterEnvParam = apvts.getRawParameterValue("filterEnv");
   filterEnabledParam = apvts.getRawParameterValue("filterEnabled");
   chordModeParam = apvts.getRawParameterValue("chordMode");
   retriggerParam = apvts.getRawParameterValue("retriggerMode");
+  chordVoiceParam = apvts.getRawParameterValue("chordVoice");
+  chordGlideParam = apvts.getRawParameterValue("chordGlide");
   lowNoteParam = apvts.getRawParameterValue("lowNote");
   highNoteParam = apvts.getRawParameterValue("highNote");
   arpEnabledParam = apvts.getRawParameterValue("arpEnabled");
@@ -42,20 +37,28 @@ MySynthAudioProcessor::MySynthAudioProcessor()
   oscRangeParam = apvts.getRawParameterValue("oscRange");
   oscLevelParam = apvts.getRawParameterValue("oscLevel");
   oscEnabledParam = apvts.getRawParameterValue("oscEnabled");
+  oscTableParam = apvts.getRawParameterValue("oscTable");
 
   oscBTypeParam = apvts.getRawParameterValue("oscBType");
   oscBRangeParam = apvts.getRawParameterValue("oscBRange");
   oscBLevelParam = apvts.getRawParameterValue("oscBLevel");
   oscBEnabledParam = apvts.getRawParameterValue("oscBEnabled");
+  oscBTableParam = apvts.getRawParameterValue("oscBTable");
+  spreadParam = apvts.getRawParameterValue("spread");
+  polyphonyParam = apvts.getRawParameterValue("polyphony");
 
   apvts.addParameterListener("lowNote", this);
   apvts.addParameterListener("highNote", this);
   apvts.addParameterListener("arpSeed", this);
 
-  generateArpPattern();
+  generateArpPattern(
+      static_cast<int>(apvts.getRawParameterValue("arpSeed")->load()));
+
+  startTimerHz(30); // Range limit corrections
 }
 
 MySynthAudioProcessor::~MySynthAudioProcessor() {
+  stopTimer();
   apvts.removeParameterListener("lowNote", this);
   apvts.removeParameterListener("highNote", this);
   apvts.removeParameterListener("arpSeed", this);
@@ -75,6 +78,8 @@ MySynthAudioProcessor::createParameterLayout() {
                                                          3.0f, 0.5f));
   layout.add(std::make_unique<juce::AudioParameterFloat>("sustain", "Sustain",
                                                          0.0f, 1.0f, 1.0f));
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+      "envCurve", "Env Curve", juce::StringArray{"Linear", "Exponential"}, 0));
 
   // Filter: Cutoff & Resonance
   auto cutoffRange = juce::NormalisableRange<float>(20.0f, 20000.0f);
@@ -95,6 +100,11 @@ MySynthAudioProcessor::createParameterLayout() {
   oscChoices.add("Sine");
   oscChoices.add("Saw");
   oscChoices.add("Square");
+  oscChoices.add("Saw BL");    // PolyBLEP band-limited
+  oscChoices.add("Square BL"); // PolyBLEP band-limited
+  oscChoices.add("Saw WT");    // Shared mip-mapped wavetable
+  oscChoices.add("Square WT"); // Shared mip-mapped wavetable
+  oscChoices.add("User");      // Table from the user wavetable library
 
   layout.add(std::make_unique<juce::AudioParameterChoice>(
       "oscType", "Oscillator Type", oscChoices, 2));
@@ -113,6 +123,10 @@ MySynthAudioProcessor::createParameterLayout() {
   layout.add(std::make_unique<juce::AudioParameterBool>(
       "oscEnabled", "Oscillator Enabled", true));
 
+  // Index into the user wavetable library (used by the "User" type)
+  layout.add(std::make_unique<juce::AudioParameterInt>(
+      "oscTable", "Oscillator Table", 0, 1023, 0));
+
   // --- Osc B ---
   layout.add(std::make_unique<juce::AudioParameterChoice>(
       "oscBType", "Oscillator B Type", oscChoices, 1));
@@ -126,21 +140,43 @@ MySynthAudioProcessor::createParameterLayout() {
   layout.add(std::make_unique<juce::AudioParameterBool>(
       "oscBEnabled", "Oscillator B Enabled", true));
 
+  layout.add(std::make_unique<juce::AudioParameterInt>(
+      "oscBTable", "Oscillator B Table", 0, 1023, 0));
+
+  layout.add(std::make_unique<juce::AudioParameterInt>(
+      "polyphony", "Polyphony", 8, VoiceBank::maxVoices, 8));
+
+  // Per-voice panning applied at mix time; 0 keeps the output mono
+  layout.add(std::make_unique<juce::AudioParameterFloat>(
+      "spread", "Stereo Spread", 0.0f, 1.0f, 0.0f));
+
   layout.add(std::make_unique<juce::AudioParameterBool>("chordMode",
                                                         "Chord Mode", true));
 
   layout.add(std::make_unique<juce::AudioParameterBool>("retriggerMode",
                                                         "Retrigger", false));
 
+  // Chord mode renders each chord on one voice: one envelope and filter for
+  // all of its notes
+  layout.add(std::make_unique<juce::AudioParameterBool>("chordVoice",
+                                                        "Chord Voice", false));
+
+  // Chord changes move the sounding voices to the new notes instead of
+  // restarting them
+  layout.add(std::make_unique<juce::AudioParameterBool>("chordGlide",
+                                                        "Chord Glide", false));
+
   layout.add(std::make_unique<juce::AudioParameterInt>(
-      juce::ParameterID("lowNote", 1), "Low Limit", 24, 127, 48,
+      juce::ParameterID("lowNote", 1), "Low Limit", lowestRangeNote,
+      highestRangeNote, 48,
       juce::AudioParameterIntAttributes().withStringFromValueFunction(
           [](int value, int) {
             return juce::MidiMessage::getMidiNoteName(value, true, true, 3);
           }))); // Default C3
 
   layout.add(std::make_unique<juce::AudioParameterInt>(
-      juce::ParameterID("highNote", 1), "High Limit", 24, 127, 84,
+      juce::ParameterID("highNote", 1), "High Limit", lowestRangeNote,
+      highestRangeNote, 84,
       juce::AudioParameterIntAttributes().withStringFromValueFunction(
           [](int value, int) {
             return juce::MidiMessage::getMidiNoteName(value, true, true, 3);
@@ -194,7 +230,11 @@ bool MySynthAudioProcessor::isMidiEffect() const {
 #endif
 }
 
-double MySynthAudioProcessor::getTailLengthSeconds() const { return 0.0; }
+double MySynthAudioProcessor::getTailLengthSeconds() const {
+  // A linear release reaches zero, and an exponential one -120 dB (where
+  // voices are freed), in the release time
+  return releaseParam->load();
+}
 
 int MySynthAudioProcessor::getNumPrograms() {
   return 1; // NB: some hosts don't cope very well if you tell them there are 0
@@ -220,14 +260,13 @@ void MySynthAudioProcessor::changeProgramName(int index,
 
 void MySynthAudioProcessor::prepareToPlay(double sampleRate,
                                           int samplesPerBlock) {
-  synthesiser.setCurrentPlaybackSampleRate(sampleRate);
+  juce::ignoreUnused(samplesPerBlock);
+  voiceManager.prepare(sampleRate);
 
-  for (int i = 0; i < synthesiser.getNumVoices(); ++i) {
-    if (auto voice = dynamic_cast<SynthVoice *>(synthesiser.getVoice(i))) {
-      voice->prepareToPlay(sampleRate, samplesPerBlock,
-                           getTotalNumOutputChannels());
-    }
-  }
+  // processBlock only ever clears and refills this
+  heldTriggerNotes.reserve(numTriggerKeys);
+
+  arpScheduler.reset();
 }
 
 void MySynthAudioProcessor::releaseResources() {
@@ -259,37 +298,66 @@ bool MySynthAudioProcessor::isBusesLayoutSupported(
 void MySynthAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                          juce::MidiBuffer &midiMessages) {
   juce::ScopedNoDenormals noDenormals;
+  RealtimeAllocationDetector::ScopedRealtimeSection realtimeSection;
   auto totalNumInputChannels = getTotalNumInputChannels();
   auto totalNumOutputChannels = getTotalNumOutputChannels();
 
   for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
     buffer.clear(i, 0, buffer.getNumSamples());
 
-  // Update parameters
-  float currentAttack = attackParam->load();
-  float currentRelease = releaseParam->load();
-  float currentDecay = decayParam->load();
-  float currentSustain = sustainParam->load();
-  float currentOscType = oscTypeParam->load();
-  float currentCutoff = cutoffParam->load();
-  float currentResonance = resonanceParam->load();
-  float currentOscRange = oscRangeParam->load();
-  float currentOscLevel = oscLevelParam->load();
-  float currentOscEnabled = oscEnabledParam->load();
-
-  float currentOscBType = oscBTypeParam->load();
-  float currentOscBRange = oscBRangeParam->load();
-  float currentOscBLevel = oscBLevelParam->load();
-  float currentOscBEnabled = oscBEnabledParam->load();
+  // Snapshot the voice parameters; the version only moves on a change
+  VoiceParameters nextVoiceParameters;
+  nextVoiceParameters.envelope = {attackParam->load(), decayParam->load(),
+                                  sustainParam->load(), releaseParam->load(),
+                                  envCurveParam->load() > 0.5f};
+  nextVoiceParameters.filter = {cutoffParam->load(), resonanceParam->load(),
+                                 filterEnvParam->load(),
+                                 filterEnabledParam->load() > 0.5f};
+  nextVoiceParameters.oscA = {static_cast<int>(oscTypeParam->load()),
+                              static_cast<int>(oscRangeParam->load()),
+                              oscLevelParam->load(),
+                              oscEnabledParam->load() > 0.5f,
+                              static_cast<int>(oscTableParam->load())};
+  nextVoiceParameters.oscB = {static_cast<int>(oscBTypeParam->load()),
+                              static_cast<int>(oscBRangeParam->load()),
+                              oscBLevelParam->load(),
+                              oscBEnabledParam->load() > 0.5f,
+                              static_cast<int>(oscBTableParam->load())};
+  voiceParameters.publish(nextVoiceParameters);
+
+  float currentSpread = spreadParam->load();
+  int currentPolyphony = static_cast<int>(polyphonyParam->load());
+
+  // MIDI layer stages in use, read once per block
+  const int midiMode = (*chordModeParam > 0.5f ? chordMidiMode : 0) |
+                       (*arpEnabledParam > 0.5f ? arpMidiMode : 0);
+  // Pass-through also needs the stages off last block, so the note-offs
+  // they send on the way out have gone
+  const bool isPassThrough = (midiMode | lastMidiMode) == 0;
+  lastMidiMode = midiMode;
+
+  bool isChordModeOn = (midiMode & chordMidiMode) != 0;
 
-  // 1. Process MIDI for Chord Mode
-  juce::MidiBuffer processedMidi;
+  // Propagate parameters to voices
+  voiceBank.setParameters(voiceParameters);
+  voiceBank.setStereoSpread(currentSpread);
+  voiceManager.setPolyphony(currentPolyphony);
+  voiceManager.setChordVoices(isChordModeOn && *chordVoiceParam > 0.5f);
+  glideChordChanges = *chordGlideParam > 0.5f;
+
+  // Fast path: the host's MIDI goes straight to the voices, uncopied
+  if (isPassThrough) {
+    wasChordModeOn = false;
+    lastLowLimit = -1; // Range changes only matter in chord mode
+    renderVoices(buffer, midiMessages);
+    return;
+  }
 
-  bool isChordModeOn = *chordModeParam > 0.5f;
+  // 1. Process MIDI for Chord Mode (into fixed storage, in time order)
+  chordEvents.clear();
 
   // Detect Range Changes
-  int currentLow = static_cast<int>(lowNoteParam->load());
-  int currentHigh = static_cast<int>(highNoteParam->load());
+  const auto [currentLow, currentHigh] = getNoteRange();
 
   bool rangeChanged = false;
   if (lastLowLimit != -1 &&
@@ -301,39 +369,33 @@ void MySynthAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
 
   if (rangeChanged && !heldTriggerNotes.empty()) {
     // Re-evaluate the held note with new range (Smart Update)
-    // IMPORTANT: Write to processedMidi, NOT midiMessages, to bypass the
+    // IMPORTANT: Write to chordEvents, NOT midiMessages, to bypass the
     // input loop (modifier detection)
 
     bool shouldRetrigger = *retriggerParam > 0.5f;
     bool useSmartUpdate = !shouldRetrigger;
 
-    playChord(heldTriggerNotes.back(), 1.0f, 0, processedMidi, useSmartUpdate);
-  }
-
-  // Propagate parameters to voices
-  for (int i = 0; i < synthesiser.getNumVoices(); ++i) {
-    if (auto voice = dynamic_cast<SynthVoice *>(synthesiser.getVoice(i))) {
-      voice->updateParameters(
-          currentAttack, currentDecay, currentSustain, currentRelease,
-          currentOscType, currentOscBRange, currentOscBLevel,
-          currentOscBEnabled, currentCutoff, currentResonance, currentOscRange,
-          currentOscLevel, currentOscEnabled, currentOscBType);
-    }
+    playChord(heldTriggerNotes.back(), 1.0f, 0, chordEvents, useSmartUpdate);
   }
 
   // Mode Switch Logic: If switching from OFF to ON, kill existing notes (with
   // release)
   if (isChordModeOn && !wasChordModeOn) {
     for (int i = 1; i <= 16; ++i)
-      synthesiser.allNotesOff(i, true);
+      voiceManager.allNotesOff(i, true);
 
-    activeChordNotes.clear();
+    setActiveChord({}, -1);
     lastTriggeredNote = -1;
   }
   wasChordModeOn = isChordModeOn;
 
   if (isChordModeOn) {
     for (const auto metadata : midiMessages) {
+      // Skip long messages (SysEx): copying one into a MidiMessage
+      // allocates, none of them is a note, and the voices ignore them
+      if (metadata.numBytes > 3)
+        continue;
+
       auto message = metadata.getMessage();
       const auto noteNumber = message.getNoteNumber();
       const auto velocity = message.getFloatVelocity();
@@ -341,63 +403,22 @@ void MySynthAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
       // ---- HANDLER FOR MODIFIERS (Octave 4: 60-71) ----
       if (noteNumber >= 60 && noteNumber <= 71) {
         bool isNoteOn = message.isNoteOn();
-        bool modifierChanged = false;
 
-        // Triads
-        if (noteNumber == 61 && isDimPressed != isNoteOn) {
-          isDimPressed = isNoteOn;
-          modifierChanged = true;
-        }
-        if (noteNumber == 63 && isMinPressed != isNoteOn) {
-          isMinPressed = isNoteOn;
-          modifierChanged = true;
-        }
-        if (noteNumber == 66 && isMajPressed != isNoteOn) {
-          isMajPressed = isNoteOn;
-          modifierChanged = true;
-        }
-        if (noteNumber == 68 && isSus2Pressed != isNoteOn) {
-          isSus2Pressed = isNoteOn;
-          modifierChanged = true;
-        }
-
-        // Extensions
-        if (noteNumber == 60 && is6Pressed != isNoteOn) {
-          is6Pressed = isNoteOn;
-          modifierChanged = true;
-        }
-        if (noteNumber == 62 && isMin7Pressed != isNoteOn) {
-          isMin7Pressed = isNoteOn;
-          modifierChanged = true;
-        }
-        if (noteNumber == 65 && isMaj7Pressed != isNoteOn) {
-          isMaj7Pressed = isNoteOn;
-          modifierChanged = true;
-        }
-        if (noteNumber == 67 && is9Pressed != isNoteOn) {
-          is9Pressed = isNoteOn;
-          modifierChanged = true;
-        }
+        const int modifier = ChordTables::getModifierForNote(noteNumber);
+        const int newMask =
+            isNoteOn ? modifierMask | modifier : modifierMask & ~modifier;
+        bool modifierChanged = newMask != modifierMask;
+        modifierMask = newMask;
 
         // If a modifier changed and we have a chord playing, re-trigger it
         if (modifierChanged && !heldTriggerNotes.empty()) {
           // Kill current chord
-          for (auto const &[rootNote, playedNotes] : activeChordNotes) {
-            for (int noteToOff : playedNotes) {
-              if (noteToOff <= 127) {
-                processedMidi.addEvent(
-                    juce::MidiMessage::noteOff(message.getChannel(), noteToOff,
-                                               0.0f), // Force off
-                    metadata.samplePosition);
-              }
-            }
-          }
-          activeChordNotes.clear();
+          stopChord(0.0f, metadata.samplePosition, chordEvents); // Force off
 
           // Re-trigger last held note with new modifiers
           int lastNote = heldTriggerNotes.back();
-          // Use processedMidi to skip re-processing this note as a modifier
-          playChord(lastNote, 1.0f, metadata.samplePosition, processedMidi);
+          // Use chordEvents to skip re-processing this note as a modifier
+          playChord(lastNote, 1.0f, metadata.samplePosition, chordEvents);
         }
 
         // Consume modifier keys (don't play them)
@@ -415,21 +436,11 @@ void MySynthAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
           heldTriggerNotes.push_back(noteNumber);
 
           // 2. Kill ANY currently sounding chord (Monophonic behavior)
-          for (auto const &[rootNote, playedNotes] : activeChordNotes) {
-            for (int noteToOff : playedNotes) {
-              if (noteToOff <= 127) {
-                processedMidi.addEvent(
-                    juce::MidiMessage::noteOff(message.getChannel(), noteToOff,
-                                               0.0f),
-                    metadata.samplePosition);
-              }
-            }
-          }
-          activeChordNotes.clear();
+          stopChord(0.0f, metadata.samplePosition, chordEvents);
 
           // 3. Trigger the NEW note (Last pressed)
           playChord(noteNumber, velocity, metadata.samplePosition,
-                    processedMidi);
+                    chordEvents);
 
           continue; // Handled
         } else if (message.isNoteOff()) {
@@ -440,23 +451,14 @@ void MySynthAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                  heldTriggerNotes.end());
 
           // 2. If the released note is the one currently sounding...
-          if (activeChordNotes.count(noteNumber)) {
-            auto oldNotes = activeChordNotes[noteNumber];
-            for (int oldNote : oldNotes) {
-              if (oldNote <= 127) {
-                processedMidi.addEvent(
-                    juce::MidiMessage::noteOff(message.getChannel(), oldNote,
-                                               velocity),
-                    metadata.samplePosition);
-              }
-            }
-            activeChordNotes.erase(noteNumber);
+          if (activeChordRoot == noteNumber) {
+            stopChord(velocity, metadata.samplePosition, chordEvents);
 
             // 3. Retrigger the specific previous note if available
             if (!heldTriggerNotes.empty()) {
               int noteToRetrigger = heldTriggerNotes.back();
               playChord(noteToRetrigger, 1.0f, metadata.samplePosition,
-                        processedMidi);
+                        chordEvents);
             } else {
               lastTriggeredNote = -1;
             }
@@ -467,56 +469,52 @@ void MySynthAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
       }
 
       // Pass through other notes
-      processedMidi.addEvent(message, metadata.samplePosition);
+      chordEvents.add(message, metadata.samplePosition);
     }
-
-    midiMessages.swapWith(processedMidi);
   }
-  // If not Chord Mode, just pass through (midiMessages stays as is)
 
-  // 2. Process Arpeggiator
-  processArpeggiator(midiMessages, buffer.getNumSamples());
+  // Modifiers and root go out together, so the editor never sees half an
+  // update
+  chordState.store(packChordState(modifierMask, lastTriggeredNote),
+                   std::memory_order_release);
 
-  // Render Audio
-  synthesiser.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+  // 2. Process Arpeggiator
+  arpEvents.clear();
+  processArpeggiator(arpEvents, buffer.getNumSamples());
+
+  // Without chord mode the host's MIDI passes through
+  const bool mergeEvents = !isChordModeOn || !arpEvents.isEmpty();
+  if (!isChordModeOn)
+    blockEvents.merge(midiMessages, arpEvents);
+  else if (mergeEvents)
+    blockEvents.merge(chordEvents, arpEvents);
+
+  const auto &events = mergeEvents ? blockEvents : chordEvents;
+  renderVoices(buffer, events);
+
+  // A full queue may have dropped a note-off; release that channel's notes
+  // rather than leave one hanging
+  const int droppedReleaseChannels =
+      chordEvents.getDroppedReleaseChannels() |
+      arpEvents.getDroppedReleaseChannels() |
+      events.getDroppedReleaseChannels();
+  for (int channel = 1; channel <= 16; ++channel)
+    if ((droppedReleaseChannels & (1 << (channel - 1))) != 0)
+      voiceManager.allNotesOff(channel, true);
 }
 
-// Helper to calculate intervals based on current modifier state
-std::vector<int> MySynthAudioProcessor::getNoteIntervals() {
-  std::vector<int> intervals;
-
-  // 1. Determine Triad (Lowest Note Priority)
-  // Priority: Dim (C#2) > Min (D#2) > Maj (F#2) > Sus2 (G#2)
-
-  if (isDimPressed) {
-    intervals.push_back(3); // Minor Third
-    intervals.push_back(6); // Diminished Fifth (Tritone)
-  } else if (isMinPressed) {
-    intervals.push_back(3); // Minor Third
-    intervals.push_back(7); // Perfect Fifth
-  } else if (isMajPressed) {
-    intervals.push_back(4); // Major Third
-    intervals.push_back(7); // Perfect Fifth
-  } else if (isSus2Pressed) {
-    intervals.push_back(2); // Major Second
-    intervals.push_back(7); // Perfect Fifth
-  }
-
-  // 2. Determine Extensions (Cumulative with strict priority)
-  // "C4: 6, D4: Min7, F4: Maj7, G4: 9"
-
-  if (is6Pressed) {           // C4 - Priority 1
-    intervals.push_back(9);   // Major 6th
-  } else if (isMin7Pressed) { // D4 - Priority 2
-    intervals.push_back(10);  // Minor 7th
-  } else if (isMaj7Pressed) { // F4 - Priority 3
-    intervals.push_back(11);  // Major 7th
-  } else if (is9Pressed) {    // G4 - Priority 4
-    intervals.push_back(10);  // Minor 7th
-    intervals.push_back(14);  // Major 9th
+template <typename Events>
+void MySynthAudioProcessor::renderVoices(juce::AudioBuffer<float> &buffer,
+                                         const Events &midi) {
+  // Nothing sounding and nothing to start: skip rendering, and clear the
+  // whole buffer so hosts can see the output is silent
+  if (voiceBank.getNumActiveVoices() == 0 && midi.isEmpty()) {
+    buffer.clear();
+    return;
   }
 
-  return intervals;
+  // Render Audio
+  voiceManager.renderNextBlock(buffer, midi, 0, buffer.getNumSamples());
 }
 
 bool MySynthAudioProcessor::hasEditor() const { return true; }
@@ -543,104 +541,107 @@ void MySynthAudioProcessor::setStateInformation(const void *data,
 
 void MySynthAudioProcessor::parameterChanged(const juce::String &parameterID,
                                              float newValue) {
-  if (parameterID == "lowNote") {
+  if (parameterID == "lowNote" || parameterID == "highNote") {
+    // This can run on the audio thread (automation), and pushing the other
+    // limit calls into the host, so the correction is left to
+    // timerCallback(). getNoteRange() applies it locally until then.
+    const int limit = parameterID == "lowNote" ? lowLimitMoved : highLimitMoved;
+    lastMovedRangeLimit.store(limit);
+    pendingRangeCorrections.fetch_or(limit);
+  } else if (parameterID == "arpSeed") {
+    generateArpPattern(static_cast<int>(newValue));
+  }
+}
+
+void MySynthAudioProcessor::timerCallback() {
+  if (pendingRangeCorrections.exchange(0) == 0)
+    return;
+
+  auto *lowParam =
+      dynamic_cast<juce::AudioParameterInt *>(apvts.getParameter("lowNote"));
+  auto *highParam =
+      dynamic_cast<juce::AudioParameterInt *>(apvts.getParameter("highNote"));
+  const int currentLow = lowParam->get();
+  const int currentHigh = highParam->get();
+
+  if (currentHigh >= currentLow + minRangeWidth)
+    return;
+
+  if (lastMovedRangeLimit.load() == lowLimitMoved) {
     // If Low Note moves up, ensure High Note is at least 12 semitones above
-    auto *highParam =
-        dynamic_cast<juce::AudioParameterInt *>(apvts.getParameter("highNote"));
-    int currentLow = static_cast<int>(newValue);
-    int currentHigh = highParam->get();
-
-    if (currentHigh < currentLow + 12) {
-      // Push High Note up
-      highParam->beginChangeGesture();
-      highParam->setValueNotifyingHost(
-          highParam->convertTo0to1(currentLow + 12));
-      highParam->endChangeGesture();
-    }
-  } else if (parameterID == "highNote") {
+    highParam->beginChangeGesture();
+    highParam->setValueNotifyingHost(
+        highParam->convertTo0to1(currentLow + minRangeWidth));
+    highParam->endChangeGesture();
+  } else {
     // If High Note moves down, ensure Low Note is at least 12 semitones
     // below
-    auto *lowParam =
-        dynamic_cast<juce::AudioParameterInt *>(apvts.getParameter("lowNote"));
-    int currentHigh = static_cast<int>(newValue);
-    int currentLow = lowParam->get();
-
-    if (currentLow > currentHigh - 12) {
-      // Push Low Note down
-      lowParam->beginChangeGesture();
-      lowParam->setValueNotifyingHost(
-          lowParam->convertTo0to1(currentHigh - 12));
-      lowParam->endChangeGesture();
-    }
-  } else if (parameterID == "arpSeed") {
-    generateArpPattern();
+    lowParam->beginChangeGesture();
+    lowParam->setValueNotifyingHost(
+        lowParam->convertTo0to1(currentHigh - minRangeWidth));
+    lowParam->endChangeGesture();
   }
 }
 
-// Creation function
-// Helper to fit note within specific MIDI range
-int MySynthAudioProcessor::fitNoteToRange(int note, int low, int high) {
-  if (low >= high)
-    return note; // Safety
-
-  int candidate = note;
+MySynthAudioProcessor::NoteRange MySynthAudioProcessor::getNoteRange() const {
+  int low = static_cast<int>(lowNoteParam->load());
+  int high = static_cast<int>(highNoteParam->load());
 
-  // Simple "while" to shift via octaves (12 semitones)
-  if (candidate < low) {
-    while (candidate < low) {
-      candidate += 12;
-    }
-  } else if (candidate > high) {
-    while (candidate > high) {
-      candidate -= 12;
-    }
+  // The same push timerCallback() makes, for limits it has not fixed yet
+  if (high < low + minRangeWidth) {
+    if (lastMovedRangeLimit.load(std::memory_order_relaxed) == lowLimitMoved)
+      high = juce::jmin(low + minRangeWidth, highestRangeNote);
+    else
+      low = juce::jmax(high - minRangeWidth, lowestRangeNote);
   }
 
-  return candidate;
+  return {low, high};
 }
 
-// Helper for display
-juce::String MySynthAudioProcessor::getChordName() {
-  if (lastTriggeredNote < 0)
-    return "";
+// Helpers for display
+MySynthAudioProcessor::ChordState
+MySynthAudioProcessor::getChordState() const {
+  const auto state = chordState.load(std::memory_order_acquire);
+  return {(int)(state & 0xff), (int)(state >> 8) - 1};
+}
 
-  return ChordNameUtils::getChordName(
-      lastTriggeredNote, isDimPressedVal(), isMinPressedVal(),
-      isMajPressedVal(), isSus2PressedVal(), is6PressedVal(),
-      isMin7PressedVal(), isMaj7PressedVal(), is9PressedVal());
+const juce::String &MySynthAudioProcessor::getChordName() const {
+  const auto state = getChordState();
+  return chordNames.get(state.rootNote, state.modifierMask);
 }
 
-void MySynthAudioProcessor::processArpeggiator(juce::MidiBuffer &midiMessages,
+void MySynthAudioProcessor::processArpeggiator(MidiEventQueue &midiMessages,
                                                int numSamples) {
   bool isArpOn = *arpEnabledParam > 0.5f;
 
   // Simple clean up if Arp was just turned off
   if (!isArpOn) {
     if (currentArpNote != -1) {
-      midiMessages.addEvent(juce::MidiMessage::noteOff(1, currentArpNote, 0.0f),
-                            0);
+      midiMessages.addNoteOff(1, currentArpNote, 0.0f, 0);
       currentArpNote = -1;
     }
     return;
   }
 
   // If no chord is active, stop arp
-  if (activeChordNotes.empty()) {
+  if (activeChordNotes.isEmpty()) {
     if (currentArpNote != -1) {
-      midiMessages.addEvent(juce::MidiMessage::noteOff(1, currentArpNote, 0.0f),
-                            0);
+      midiMessages.addNoteOff(1, currentArpNote, 0.0f, 0);
       currentArpNote = -1;
     }
     arpSequenceStep = 0; // Reset sequence when no chord played
     return;
   }
 
-  // Calculate Rate
+  // Calculate Rate, locked to the host transport while it runs
   double bpm = 120.0;
+  std::optional<double> hostPpq;
   if (auto *ph = getPlayHead()) {
     if (auto position = ph->getPosition()) {
-      if (position->getBpm().hasValue())
+      if (position->getBpm().hasValue() && *position->getBpm() > 0.0)
         bpm = *position->getBpm();
+      if (position->getIsPlaying() && position->getPpqPosition().hasValue())
+        hostPpq = *position->getPpqPosition();
     }
   }
 
@@ -651,203 +652,115 @@ void MySynthAudioProcessor::processArpeggiator(juce::MidiBuffer &midiMessages,
   if (rateIndex > 5)
     rateIndex = 5;
 
-  // "1/2", "1/4", "1/8", "1/16", "1/32", "1/64"
-  double denominator = std::pow(2.0, rateIndex + 1); // 2^1=2, 2^2=4, ...
-  double beatsPerSec = bpm / 60.0;
-  double samplesPerSec = getSampleRate();
-  double samplesPerBeat = samplesPerSec / beatsPerSec;
-  double samplesPerStep = samplesPerBeat * (4.0 / denominator);
-
-  // Collect all valid notes from active chords
-  std::vector<int> pool;
-  for (auto const &[root, notes] : activeChordNotes) {
-    for (int n : notes) {
-      if (n >= 0 && n <= 127)
-        pool.push_back(n);
-    }
-  }
-  std::sort(pool.begin(), pool.end());
+  // "1/2", "1/4", "1/8", "1/16", "1/32", "1/64": 2 quarters at 1/2, halving
+  // with each step, which is exact in ticks
+  const std::int64_t stepTicks =
+      (2 * ArpScheduler::ticksPerQuarter) >> rateIndex;
 
-  if (pool.empty())
-    return;
+  const auto &arpPattern = arpPatterns.read();
 
-  // Run Arp Logic
-  // Phase goes from 0 to samplesPerStep
-  // In this block, we advance phase by numSamples.
-  // If phase crosses threshold, trigger.
+  arpScheduler.process(
+      hostPpq, bpm, getSampleRate(), stepTicks, numSamples,
+      [&](int triggerOffset) {
+        // 1. Note Off Previous
+        if (currentArpNote != -1) {
+          midiMessages.addNoteOff(1, currentArpNote, 0.0f, triggerOffset);
+        }
 
-  double samplesRemainingInBlock = numSamples;
-  int currentSampleOffset = 0;
+        // 2. Pick New Note (Deterministic based on Seed/Pattern)
+        int rawRandom = arpPattern[arpSequenceStep % arpPattern.size()];
+        int randIndex = std::abs(rawRandom) % arpPoolSize;
+        currentArpNote = arpPool[(size_t)randIndex];
 
-  while (samplesRemainingInBlock > 0) {
-    double samplesUntilNextTrigger = samplesPerStep - arpPhase;
+        arpSequenceStep++;
 
-    if (samplesUntilNextTrigger <= samplesRemainingInBlock) {
-      // Trigger happens in this block
-      int triggerOffset = currentSampleOffset + (int)samplesUntilNextTrigger;
+        // Visualization: Send band index (rank % 5) to Editor
+        auto writer = visualFifo.write(1);
+        if (writer.blockSize1 > 0)
+          visualBuffer[(size_t)writer.startIndex1] = randIndex % 5;
 
-      // 1. Note Off Previous
-      if (currentArpNote != -1) {
-        midiMessages.addEvent(
-            juce::MidiMessage::noteOff(1, currentArpNote, 0.0f), triggerOffset);
-      }
+        // 3. Note On New
+        midiMessages.addNoteOn(1, currentArpNote, 1.0f, triggerOffset);
+      });
+}
 
-      // 2. Pick New Note (Deterministic based on Seed/Pattern)
-      int rawRandom = arpPattern[arpSequenceStep % arpPattern.size()];
-      int randIndex = std::abs(rawRandom) % (int)pool.size();
-      currentArpNote = pool[randIndex];
-
-      arpSequenceStep++;
-
-      // Visualization: Send band index (rank % 5) to Editor
-      auto writer = visualFifo.write(1);
-      if (writer.blockSize1 > 0)
-        visualBuffer[(size_t)writer.startIndex1] = randIndex % 5;
-
-      // 3. Note On New
-      midiMessages.addEvent(juce::MidiMessage::noteOn(1, currentArpNote, 1.0f),
-                            triggerOffset);
-
-      // Reset Phase
-      arpPhase = 0;
-      // Technically we should subtract the utilized samples
-      double utilized = samplesUntilNextTrigger;
-      currentSampleOffset += (int)utilized;
-      samplesRemainingInBlock -= utilized;
-    } else {
-      // No trigger in rest of block
-      arpPhase += samplesRemainingInBlock;
-      samplesRemainingInBlock = 0;
-    }
-  }
+void MySynthAudioProcessor::generateArpPattern(int seed) {
+  requestedArpSeed.store(seed);
+
+  // Build until the newest request is published. A writer that arrives
+  // while the lock is held returns at once; the holder sees its seed on
+  // the check after unlocking and builds again.
+  int builtSeed;
+  do {
+    const juce::SpinLock::ScopedTryLockType lock(arpPatternWriteLock);
+    if (!lock.isLocked())
+      return;
+
+    builtSeed = requestedArpSeed.load();
+    juce::Random rng(builtSeed);
+    for (int &val : arpPatterns.getWriteBuffer())
+      val = rng.nextInt();
+    arpPatterns.publish();
+  } while (requestedArpSeed.load() != builtSeed);
 }
 
-void MySynthAudioProcessor::generateArpPattern() {
-  int seedVal = 12345;
-  if (auto *p = apvts.getParameter("arpSeed")) {
-    // AudioParameterInt::get() returns int
-    if (auto *intP = dynamic_cast<juce::AudioParameterInt *>(p)) {
-      seedVal = intP->get();
-    }
-  }
+void MySynthAudioProcessor::stopChord(float velocity, int sampleOffset,
+                                      MidiEventQueue &midiMessages) {
+  activeChordNotes.forEach([&](int note) {
+    midiMessages.addNoteOff(1, note, velocity, sampleOffset,
+                            glideChordChanges);
+  });
 
-  juce::Random rng(seedVal);
-  arpPattern.resize(1024); // Large enough cycle
-  for (int &val : arpPattern) {
-    val = rng.nextInt();
-  }
+  setActiveChord({}, -1);
+}
+
+void MySynthAudioProcessor::setActiveChord(const NoteSet &notes,
+                                           int rootNote) {
+  activeChordNotes = notes;
+  activeChordRoot = rootNote;
+
+  arpPoolSize = 0;
+  notes.forEach([this](int note) { arpPool[(size_t)arpPoolSize++] = note; });
 }
 
 // Helper to trigger a chord
 void MySynthAudioProcessor::playChord(int triggerNote, float velocity,
                                       int sampleOffset,
-                                      juce::MidiBuffer &midiMessages,
+                                      MidiEventQueue &midiMessages,
                                       bool isSmartUpdate) {
   bool isArpOn = *arpEnabledParam > 0.5f;
 
-  int lowLimit = static_cast<int>(lowNoteParam->load());
-  int highLimit = static_cast<int>(highNoteParam->load());
-
-  auto intervals = getNoteIntervals();
-  std::vector<int> targetChordNotes;
-
-  // Helper lambda to add all instances of a pitch class within range
-  // Constrained to NEVER generate notes below the triggerNote to prevent Root
-  // replacement
-  auto addNotesInRange = [&](int baseNote) {
-    int pitchClass = baseNote % 12;
+  const auto [lowLimit, highLimit] = getNoteRange();
 
-    int candidate = lowLimit;
-    int candidatePitchClass = candidate % 12;
+  // 1. Look up the target notes for this range, modifiers and root
+  chordCache.setRange(lowLimit, highLimit);
+  const auto targetChordNotes =
+      chordCache.getNotes(modifierMask, triggerNote);
 
-    int diff = pitchClass - candidatePitchClass;
-    if (diff < 0)
-      diff += 12;
-
-    candidate += diff;
-
-    while (candidate <= highLimit) {
-      if (candidate <= 127) {
-        bool exists = false;
-
-        for (int n : targetChordNotes) {
-          if (n == candidate) {
-            exists = true;
-            break;
-          }
-        }
-        if (!exists)
-          targetChordNotes.push_back(candidate);
-      }
-      candidate += 12;
-    }
+  auto noteOff = [&](int note) {
+    midiMessages.addNoteOff(1, note, 0.0f, sampleOffset, glideChordChanges);
+  };
+  auto noteOn = [&](int note) {
+    midiMessages.addNoteOn(1, note, velocity, sampleOffset, glideChordChanges);
   };
-
-  // 1. Calculate Target Notes (Filling Strategy)
-
-  // A. Fill Range with Root Octaves
-  addNotesInRange(triggerNote);
-
-  // B. Fill Range with Intervals
-  if (!intervals.empty()) {
-    for (int interval : intervals) {
-      addNotesInRange(triggerNote + interval);
-    }
-  }
 
   // 2. Diffing or Direct Play
-  std::vector<int> &currentNotes = activeChordNotes[triggerNote];
-
   if (isSmartUpdate) {
     // A. Stop notes that are in current but NOT in target
-    for (int oldNote : currentNotes) {
-      bool stillPlaying = false;
-      for (int newNote : targetChordNotes) {
-        if (newNote == oldNote) {
-          stillPlaying = true;
-          break;
-        }
-      }
-      if (!stillPlaying) {
-        midiMessages.addEvent(juce::MidiMessage::noteOff(1, oldNote, 0.0f),
-                              sampleOffset);
-      }
-    }
+    activeChordNotes.without(targetChordNotes).forEach(noteOff);
 
     // B. Start notes that are in target but NOT in current
-    for (int newNote : targetChordNotes) {
-      bool alreadyPlaying = false;
-      for (int oldNote : currentNotes) {
-        if (oldNote == newNote) {
-          alreadyPlaying = true;
-          break;
-        }
-      }
-      if (!alreadyPlaying && !isArpOn) {
-        midiMessages.addEvent(juce::MidiMessage::noteOn(1, newNote, velocity),
-                              sampleOffset);
-      }
-    }
-
+    if (!isArpOn)
+      targetChordNotes.without(activeChordNotes).forEach(noteOn);
   } else {
     // Retrigger Behavior: Kill old notes, play new ones
-    // 1. Stop ALL currently active notes for this trigger
-    for (int oldNote : currentNotes) {
-      midiMessages.addEvent(juce::MidiMessage::noteOff(1, oldNote, 0.0f),
-                            sampleOffset);
-    }
-
-    // 2. Play ALL target notes
-    if (!isArpOn) {
-      for (int note : targetChordNotes) {
-        midiMessages.addEvent(juce::MidiMessage::noteOn(1, note, velocity),
-                              sampleOffset);
-      }
-    }
+    activeChordNotes.forEach(noteOff);
+    if (!isArpOn)
+      targetChordNotes.forEach(noteOn);
   }
 
   // 3. Update State
-  activeChordNotes[triggerNote] = targetChordNotes;
+  setActiveChord(targetChordNotes, triggerNote);
   lastTriggeredNote = triggerNote;
 }
 
@@ -1,11 +1,19 @@
 #pragma once
 
-#include "SynthVoice.h"
+#include "ArpScheduler.h"
+#include "ChordNameUtils.h"
+#include "ChordTables.h"
+#include "MidiEventQueue.h"
+#include "TripleBuffer.h"
+#include "VoiceManager.h"
+#include "WavetableBank.h"
+#include "WavetableLibrary.h"
 #include <JuceHeader.h>
 
 class MySynthAudioProcessor
     : public juce::AudioProcessor,
-      public juce::AudioProcessorValueTreeState::Listener {
+      public juce::AudioProcessorValueTreeState::Listener,
+      private juce::Timer {
 public:
   MySynthAudioProcessor();
   ~MySynthAudioProcessor() override;
@@ -46,26 +54,30 @@ public:
   juce::AudioProcessorValueTreeState apvts{*this, nullptr, "Parameters",
                                            createParameterLayout()};
 
-  // Public getters for modifier state (for visualizer)
-  bool isDimPressedVal() const { return isDimPressed; }
-  bool isMinPressedVal() const { return isMinPressed; }
-  bool isMajPressedVal() const { return isMajPressed; }
-  bool isSus2PressedVal() const { return isSus2Pressed; }
+  // Chord mode state for the visualizer, as last published by the audio
+  // thread. Modifiers and root come from the same block, never torn.
+  struct ChordState {
+    int modifierMask; // ChordTables::Modifier bits
+    int rootNote;     // Last triggered note, -1 when none
+  };
+  ChordState getChordState() const;
 
-  bool is6PressedVal() const { return is6Pressed; }
-  bool isMin7PressedVal() const { return isMin7Pressed; }
-  bool isMaj7PressedVal() const { return isMaj7Pressed; }
-
-  bool is9PressedVal() const { return is9Pressed; }
-
-  juce::String getChordName();
+  const juce::String &getChordName() const;
 
   // FIFO for Arpeggiator Visualization
   juce::AbstractFifo visualFifo{64};
   std::array<int, 64> visualBuffer;
 
 private:
-  juce::Synthesiser synthesiser;
+  // Process-wide wavetables, shared by every instance (must outlive voices)
+  juce::SharedResourcePointer<WavetableBank> wavetableBank;
+  // Memory-mapped user wavetables, also shared between instances
+  juce::SharedResourcePointer<WavetableLibrary> wavetableLibrary;
+
+  // DSP state of every voice, and the MIDI -> voice allocation driving it
+  VoiceBank voiceBank{*wavetableBank, *wavetableLibrary};
+  VoiceManager voiceManager{voiceBank};
+  VoiceParameters voiceParameters;
 
   // Cached pointers for fast access in processBlock
   std::atomic<float> *attackParam = nullptr;
@@ -73,76 +85,134 @@ private:
   std::atomic<float> *oscTypeParam = nullptr;
   std::atomic<float> *decayParam = nullptr;
   std::atomic<float> *sustainParam = nullptr;
+  std::atomic<float> *envCurveParam = nullptr;
   std::atomic<float> *cutoffParam = nullptr;
   std::atomic<float> *resonanceParam = nullptr;
   std::atomic<float> *filterEnvParam = nullptr;
   std::atomic<float> *filterEnabledParam = nullptr;
   std::atomic<float> *chordModeParam = nullptr;
   std::atomic<float> *retriggerParam = nullptr;
+  std::atomic<float> *chordVoiceParam = nullptr;
+  std::atomic<float> *chordGlideParam = nullptr;
 
   std::atomic<float> *lowNoteParam = nullptr;
   std::atomic<float> *highNoteParam = nullptr;
   std::atomic<float> *oscRangeParam = nullptr;
   std::atomic<float> *oscLevelParam = nullptr;
   std::atomic<float> *oscEnabledParam = nullptr;
+  std::atomic<float> *oscTableParam = nullptr;
 
   std::atomic<float> *oscBTypeParam = nullptr;
   std::atomic<float> *oscBRangeParam = nullptr;
   std::atomic<float> *oscBLevelParam = nullptr;
   std::atomic<float> *oscBEnabledParam = nullptr;
+  std::atomic<float> *oscBTableParam = nullptr;
+  std::atomic<float> *spreadParam = nullptr;
+  std::atomic<float> *polyphonyParam = nullptr;
 
   // Arpeggiator Parameters
   std::atomic<float> *arpEnabledParam = nullptr;
   std::atomic<float> *arpRateParam = nullptr;
 
-  // Helper to fit note within specific MIDI range (inversions)
-  int fitNoteToRange(int note, int low, int high);
+  // Chord range limits, kept at least minRangeWidth apart. parameterChanged
+  // only flags which limit moved; timerCallback() pushes the other one on the
+  // message thread, so the audio thread never calls into the host.
+  static constexpr int lowestRangeNote = 24;
+  static constexpr int highestRangeNote = 127;
+  static constexpr int minRangeWidth = 12;
+  enum RangeLimit { lowLimitMoved = 1, highLimitMoved = 2 };
+  std::atomic<int> pendingRangeCorrections{0};
+  std::atomic<int> lastMovedRangeLimit{lowLimitMoved};
 
-  // Chord Mode internal state
-  // Triad Modifiers
-  std::atomic<bool> isDimPressed{false};  // C#2
-  std::atomic<bool> isMinPressed{false};  // D#2
-  std::atomic<bool> isMajPressed{false};  // F#2
-  std::atomic<bool> isSus2Pressed{false}; // G#2
+  void timerCallback() override;
 
-  // Extension Modifiers
-  std::atomic<bool> is6Pressed{false};    // C4
-  std::atomic<bool> isMin7Pressed{false}; // D4
-  std::atomic<bool> isMaj7Pressed{false}; // F4
-  std::atomic<bool> is9Pressed{false};    // G4
+  struct NoteRange {
+    int low, high;
+  };
+  // The limits with any pending correction already applied
+  NoteRange getNoteRange() const;
+
+  // Chord Mode internal state (audio thread only)
+  // Held modifier keys, as ChordTables::Modifier bits
+  int modifierMask = 0;
 
   // Track previous mode state for transition handling
   bool wasChordModeOn = true; // Default to true to match default parameter
 
+  // MIDI layer stages, as bits of a mode word; with none in use the host's
+  // MIDI is passed straight to the voices
+  enum MidiMode { chordMidiMode = 1, arpMidiMode = 2 };
+  int lastMidiMode = chordMidiMode; // Chord mode is on by default
+
+  // Renders the voices from midi (a MidiBuffer or MidiEventQueue), or
+  // clears the buffer when idle
+  template <typename Events>
+  void renderVoices(juce::AudioBuffer<float> &buffer, const Events &midi);
+
   // Last Triggered Note (Root) for Display
-  std::atomic<int> lastTriggeredNote{-1};
+  int lastTriggeredNote = -1;
+
+  // modifierMask in the low byte, lastTriggeredNote + 1 above it; stored
+  // once per block
+  static constexpr std::uint32_t packChordState(int modifiers, int rootNote) {
+    return (std::uint32_t)modifiers | (std::uint32_t)(rootNote + 1) << 8;
+  }
+  std::atomic<std::uint32_t> chordState{packChordState(0, -1)};
+  const ChordNameUtils::ChordNameTable chordNames;
 
   // Arpeggiator State
   int currentArpNote = -1;
-  double arpPhase = 0.0;
-  double samplesPerBeat = 0.0;
-  double noteDurationInSamples = 0.0;
-  int arpSortOrder = 0; // 0: Random (for now), could extend
-  juce::Random random;
+  ArpScheduler arpScheduler;
 
   // Deterministic Arp Logic
-  // const int arpSeed = 12345; // Replaced by Parameter
-  std::vector<int> arpPattern; // Stores raw random numbers
+  // Raw random numbers, rebuilt off the audio thread when the seed moves and
+  // picked up by processArpeggiator at its next block
+  static constexpr int arpPatternLength = 1024; // Large enough cycle
+  using ArpPattern = std::array<int, arpPatternLength>;
+  TripleBuffer<ArpPattern> arpPatterns;
+  // Serialises writers; a writer that finds it taken leaves its seed to the
+  // holder instead of waiting
+  juce::SpinLock arpPatternWriteLock;
+  std::atomic<int> requestedArpSeed{0};
   int arpSequenceStep = 0;
-  void generateArpPattern();
+  void generateArpPattern(int seed);
 
   // Helper to handle Arp logic
-  void processArpeggiator(juce::MidiBuffer &midiMessages, int numSamples);
+  void processArpeggiator(MidiEventQueue &midiMessages, int numSamples);
+
+  // Chord notes for the current note range, looked up by modifiers and root
+  ChordTables::ChordCache chordCache;
+
+  // The sounding chord (absolute MIDI numbers) and the trigger key that
+  // played it, to ensure correct NoteOffs
+  NoteSet activeChordNotes;
+  int activeChordRoot = -1;
 
-  // Helper to calculate intervals based on current state
-  std::vector<int> getNoteIntervals();
+  // Marks the notes stopChord/playChord send as legato, so the voices glide
+  // from one chord to the next; arp steps and other notes never are
+  bool glideChordChanges = false;
 
-  // Track active chord notes (absolute MIDI numbers) to ensure correct NoteOffs
-  // Key: Trigger Note Number, Value: Vector of actual played MIDI notes
-  std::map<int, std::vector<int>> activeChordNotes;
+  // Sends note-offs for the sounding chord and forgets it
+  void stopChord(float velocity, int sampleOffset,
+                 MidiEventQueue &midiMessages);
+  // Replaces the sounding chord and rebuilds the arp pool from it
+  void setActiveChord(const NoteSet &notes, int rootNote);
+
+  // The active chord's notes, lowest first, for the arpeggiator to pick from
+  std::array<int, NoteSet::numNotes> arpPool{};
+  int arpPoolSize = 0;
 
   // Track physically held trigger keys to handle Last-Note Priority
+  // (reserved for every trigger key in prepareToPlay)
   std::vector<int> heldTriggerNotes;
+  static constexpr int numTriggerKeys = 12;
+
+  // The block's MIDI in fixed storage, so adding events never allocates:
+  // chord mode's output (generated notes and the host notes it passes
+  // through), the arpeggiator's, and the two merged for the voices
+  MidiEventQueue chordEvents;
+  MidiEventQueue arpEvents;
+  MidiEventQueue blockEvents;
 
   // Track previous limits to detect changes
   int lastLowLimit = -1;
@@ -150,7 +220,7 @@ private:
 
   // Helper to trigger a chord
   void playChord(int triggerNote, float velocity, int sampleOffset,
-                 juce::MidiBuffer &midiMessages, bool isSmartUpdate = false);
+                 MidiEventQueue &midiMessages, bool isSmartUpdate = false);
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MySynthAudioProcessor)
 };
@@ -0,0 +1,236 @@
+#include "RealtimeAllocationDetector.h"
+
+#if MYSYNTH_DETECT_RT_ALLOCATIONS
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Initial-exec TLS: the default model can call malloc on a thread's first
+// access, which would recurse into the hooks below
+#if defined(__GNUC__)
+__attribute__((tls_model("initial-exec")))
+#endif
+thread_local int realtimeDepth = 0;
+
+void checkAllocation(const char *function) noexcept {
+  if (realtimeDepth == 0)
+    return;
+
+  // Reporting may allocate too
+  realtimeDepth = 0;
+  std::fprintf(stderr, "%s called inside a real-time section\n", function);
+  std::abort();
+}
+
+} // namespace
+
+namespace RealtimeAllocationDetector {
+
+void enterRealtimeSection() noexcept { ++realtimeDepth; }
+void leaveRealtimeSection() noexcept { --realtimeDepth; }
+
+} // namespace RealtimeAllocationDetector
+
+#if defined(__GLIBC__)
+
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *pointer, std::size_t size);
+void __libc_free(void *pointer);
+void *__libc_memalign(std::size_t alignment, std::size_t size);
+void *__libc_valloc(std::size_t size);
+void *__libc_pvalloc(std::size_t size);
+
+void *malloc(std::size_t size) noexcept {
+  checkAllocation("malloc");
+  return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept {
+  checkAllocation("calloc");
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, std::size_t size) noexcept {
+  checkAllocation("realloc");
+  return __libc_realloc(pointer, size);
+}
+
+void free(void *pointer) noexcept {
+  if (pointer != nullptr)
+    checkAllocation("free");
+  __libc_free(pointer);
+}
+
+// The aligned allocators do not go through malloc in glibc
+void *aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+  checkAllocation("aligned_alloc");
+  return __libc_memalign(alignment, size);
+}
+
+void *memalign(std::size_t alignment, std::size_t size) noexcept {
+  checkAllocation("memalign");
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **result, std::size_t alignment,
+                   std::size_t size) noexcept {
+  checkAllocation("posix_memalign");
+  if (alignment == 0 || alignment % sizeof(void *) != 0 ||
+      (alignment & (alignment - 1)) != 0)
+    return EINVAL;
+
+  auto *pointer = __libc_memalign(alignment, size);
+  if (pointer == nullptr)
+    return ENOMEM;
+
+  *result = pointer;
+  return 0;
+}
+
+void *valloc(std::size_t size) noexcept {
+  checkAllocation("valloc");
+  return __libc_valloc(size);
+}
+
+void *pvalloc(std::size_t size) noexcept {
+  checkAllocation("pvalloc");
+  return __libc_pvalloc(size);
+}
+}
+
+#else
+
+namespace {
+
+void *allocateAligned(std::size_t size, std::align_val_t alignment) noexcept {
+  const auto bytes = size == 0 ? 1 : size;
+  auto align = (std::size_t)alignment;
+#if defined(_WIN32)
+  return _aligned_malloc(bytes, align);
+#else
+  if (align < sizeof(void *))
+    align = sizeof(void *);
+
+  void *pointer = nullptr;
+  return posix_memalign(&pointer, align, bytes) == 0 ? pointer : nullptr;
+#endif
+}
+
+void freeAligned(void *pointer) noexcept {
+#if defined(_WIN32)
+  _aligned_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  checkAllocation("operator new");
+  if (auto *pointer = std::malloc(size == 0 ? 1 : size))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void *pointer) noexcept {
+  if (pointer != nullptr)
+    checkAllocation("operator delete");
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept { operator delete(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  operator delete(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+  operator delete(pointer);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  checkAllocation("operator new");
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return operator new(size, std::nothrow);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+  operator delete(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+  operator delete(pointer);
+}
+
+// Over-aligned types (alignas above the default new alignment)
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  checkAllocation("operator new");
+  if (auto *pointer = allocateAligned(size, alignment))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t &) noexcept {
+  checkAllocation("operator new");
+  return allocateAligned(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+  return operator new(size, alignment, std::nothrow);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+  if (pointer != nullptr)
+    checkAllocation("operator delete");
+  freeAligned(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t alignment) noexcept {
+  operator delete(pointer, alignment);
+}
+
+void operator delete(void *pointer, std::size_t,
+                     std::align_val_t alignment) noexcept {
+  operator delete(pointer, alignment);
+}
+
+void operator delete[](void *pointer, std::size_t,
+                       std::align_val_t alignment) noexcept {
+  operator delete(pointer, alignment);
+}
+
+void operator delete(void *pointer, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+  operator delete(pointer, alignment);
+}
+
+void operator delete[](void *pointer, std::align_val_t alignment,
+                       const std::nothrow_t &) noexcept {
+  operator delete(pointer, alignment);
+}
+
+#endif
+
+#endif
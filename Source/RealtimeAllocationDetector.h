@@ -0,0 +1,34 @@
+#pragma once
+
+// Debug aid for the audio path, enabled with the MYSYNTH_DETECT_RT_ALLOCATIONS
+// CMake option: while a ScopedRealtimeSection is alive on a thread, any heap
+// allocation or free on that thread prints what it was and aborts.
+//
+// With glibc every malloc, calloc, realloc, free and aligned allocation
+// (aligned_alloc, posix_memalign, memalign, valloc, pvalloc) is caught.
+// Elsewhere only operator new and delete are replaced, in every form
+// (aligned and nothrow included), so a direct malloc goes unnoticed.
+// The hooks replace the process allocator, so they only take effect where
+// this code is linked into the executable (the Standalone app or the
+// MySynthRealtimeTest harness), not in a plugin loaded by a host.
+//
+// Without the option the section is empty and the allocator is untouched.
+namespace RealtimeAllocationDetector {
+
+#if MYSYNTH_DETECT_RT_ALLOCATIONS
+void enterRealtimeSection() noexcept;
+void leaveRealtimeSection() noexcept;
+#else
+inline void enterRealtimeSection() noexcept {}
+inline void leaveRealtimeSection() noexcept {}
+#endif
+
+struct ScopedRealtimeSection {
+  ScopedRealtimeSection() noexcept { enterRealtimeSection(); }
+  ~ScopedRealtimeSection() { leaveRealtimeSection(); }
+
+  ScopedRealtimeSection(const ScopedRealtimeSection &) = delete;
+  ScopedRealtimeSection &operator=(const ScopedRealtimeSection &) = delete;
+};
+
+} // namespace RealtimeAllocationDetector
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Hands the latest value from one writer to one reader without locks. The
+// writer fills its back buffer and swaps it into the middle slot; the reader
+// swaps the middle slot for its front buffer when a newer value is waiting.
+// Neither side ever waits, and each buffer is only touched by one side at a
+// time, so nothing needs reclaiming: all three live as long as this object.
+template <typename T> class TripleBuffer {
+public:
+  // Writer side: fill this, then publish()
+  T &getWriteBuffer() { return buffers[(size_t)backIndex]; }
+  void publish() {
+    backIndex =
+        middle.exchange(backIndex | freshBit, std::memory_order_acq_rel) &
+        indexMask;
+  }
+
+  // Reader side: the newest published value
+  const T &read() {
+    if ((middle.load(std::memory_order_relaxed) & freshBit) != 0)
+      frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) &
+                   indexMask;
+    return buffers[(size_t)frontIndex];
+  }
+
+private:
+  static constexpr int indexMask = 3;
+  static constexpr int freshBit = 4; // Set on the middle slot by publish()
+
+  std::array<T, 3> buffers{};
+  int backIndex{0};
+  std::atomic<int> middle{1};
+  int frontIndex{2};
+};
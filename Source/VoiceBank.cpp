@@ -0,0 +1,797 @@
+#include "VoiceBank.h"
+
+static_assert(VoiceBankKernels::wavetableSize == WavetableBank::tableSize,
+              "Kernels interpolate over the bank's table size");
+static_assert(VoiceBankKernels::numWaveforms == 8,
+              "Waveform order must match the oscType choices");
+
+namespace {
+// Pan position per voice index, alternating sides so consecutively allocated
+// voices (e.g. the notes of a chord) land apart
+constexpr std::array<float, 8> voicePanPositions{-1.0f,  1.0f,  -0.5f, 0.5f,
+                                                 -0.75f, 0.75f, -0.25f, 0.25f};
+
+struct FilterCoefficients {
+  float g, r2, h;
+};
+
+// As in juce::dsp::StateVariableTPTFilter
+FilterCoefficients makeFilterCoefficients(float cutoff, float resonance,
+                                          double sampleRate) {
+  auto nyquist = static_cast<float>(sampleRate * 0.5);
+  auto cutoffHz = juce::jlimit(1.0f, nyquist * 0.999f, cutoff);
+
+  FilterCoefficients coefficients;
+  coefficients.g = static_cast<float>(
+      std::tan(juce::MathConstants<double>::pi * cutoffHz / sampleRate));
+  coefficients.r2 = 1.0f / resonance;
+  coefficients.h = 1.0f / (1.0f + coefficients.r2 * coefficients.g +
+                           coefficients.g * coefficients.g);
+  return coefficients;
+}
+
+// An exponential attack charges towards this level and is cut off at full
+// scale, keeping the steep top of an analogue RC attack
+constexpr double exponentialAttackTarget = 1.3;
+
+// Lanes the kernels walk for a given number of active slots
+int getNumLanes(int numActiveVoices) {
+  constexpr int padding = VoiceBankKernels::maxWidth;
+  return (numActiveVoices + padding - 1) / padding * padding;
+}
+} // namespace
+
+VoiceBank::VoiceBank(const WavetableBank &wavetableBank,
+                     WavetableLibrary &wavetableLibrary)
+    : bank(wavetableBank), library(wavetableLibrary) {
+  // Widest instruction set this CPU can run
+  kernels = VoiceBankKernels::getBaselineKernels();
+
+  auto avxKernels = VoiceBankKernels::getAVXKernels();
+  if (avxKernels.width > 0 && juce::SystemStats::hasAVX())
+    kernels = avxKernels;
+}
+
+void VoiceBank::prepare(double sampleRate, int newNumVoices) {
+  jassert(newNumVoices <= maxVoices);
+
+  currentSampleRate = sampleRate;
+  numVoices = newNumVoices;
+  numActiveVoices = 0;
+
+  // Coefficients depend on the sample rate; take the next snapshot in full
+  hasAppliedParameters = false;
+  filterRamping = false;
+  filterModulated = false;
+
+  cutoffSmoother.reset(sampleRate, smoothingTimeSeconds);
+  resonanceSmoother.reset(sampleRate, smoothingTimeSeconds);
+  settingsA.level.reset(sampleRate, smoothingTimeSeconds);
+  settingsB.level.reset(sampleRate, smoothingTimeSeconds);
+
+  // Pad so every kernel width covers whole groups; padding lanes stay inactive
+  const auto size = (size_t)getNumLanes(numVoices);
+
+  slotOfVoice.assign((size_t)numVoices, -1);
+  voiceOfSlot.assign(size, -1);
+  finishedVoices.clear();
+  finishedVoices.reserve((size_t)numVoices);
+
+  for (auto &layer : layers) {
+    for (auto *osc : {&layer.oscA, &layer.oscB}) {
+      osc->phase.assign(size, 0.0f); // x = -pi, as juce::dsp::Oscillator
+      osc->increment.assign(size, 0.0f);
+      osc->inverseIncrement.assign(size, 0.0f);
+      osc->tables.assign(size, nullptr);
+    }
+    layer.active.assign(size, 0.0f);
+  }
+  numLayers.assign(size, 0);
+
+  filterS1.assign(size, 0.0f);
+  filterS2.assign(size, 0.0f);
+  filterG.assign(size, 0.0f);
+  filterR2.assign(size, 1.0f);
+  filterH.assign(size, 1.0f);
+  filterGStep.assign(size, 0.0f);
+  filterR2Step.assign(size, 0.0f);
+  filterHStep.assign(size, 0.0f);
+
+  envelopeStage.assign(size, EnvelopeStage::Idle);
+  envelopeLevel.assign(size, 0.0f);
+  envelopeReleaseOffset.assign(size, 0.0f);
+  envelopeSegment.assign(size);
+  envelopeNextSegment.assign(size);
+  envelopeSwitchLevel.assign(size, VoiceBankKernels::noSwitchLevel);
+  envelopeSwitched.assign(size, 0.0f);
+  updateEnvelopeSegments();
+
+  panLeft.assign(size, 1.0f);
+  panRight.assign(size, 1.0f);
+  voicePeak.assign(size, 0.0f);
+  voiceQuietSamples.assign(size, 0);
+  cullHoldSamples = static_cast<int>(sampleRate * cullHoldSeconds);
+  voiceActive.assign(size, 0.0f);
+
+  const auto scratchSize = (size_t)VoiceBankKernels::maxChunkSize * size;
+  mixScratch.assign(scratchSize, 0.0f);
+  envelopeScratch.assign(scratchSize, 0.0f);
+}
+
+void VoiceBank::setFrequency(OscillatorState &state, int slot,
+                             float frequencyHz) {
+  // Keep the increment below Nyquist so the phase wraps at most once per step
+  auto nyquist = static_cast<float>(currentSampleRate * 0.5);
+  auto increment = juce::jlimit(0.0f, nyquist, frequencyHz) /
+                   static_cast<float>(currentSampleRate);
+
+  state.increment[(size_t)slot] = increment;
+  state.inverseIncrement[(size_t)slot] =
+      increment > 0.0f ? 1.0f / increment : 0.0f;
+}
+
+void VoiceBank::setLayerNote(int slot, int noteIndex, int midiNoteNumber) {
+  auto &layer = layers[(size_t)noteIndex];
+  auto hz = static_cast<float>(
+      juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber));
+
+  setFrequency(layer.oscA, slot, hz * settingsA.frequencyMultiplier);
+  setFrequency(layer.oscB, slot, hz * settingsB.frequencyMultiplier);
+}
+
+void VoiceBank::startVoice(int voice, std::span<const int> midiNoteNumbers) {
+  jassert(juce::isPositiveAndBelow(voice, numVoices));
+  jassert(!midiNoteNumbers.empty() &&
+          midiNoteNumbers.size() <= (size_t)maxVoiceNotes);
+
+  const auto numNotes =
+      juce::jmin((int)midiNoteNumbers.size(), maxVoiceNotes);
+
+  // The manager only starts voices it has freed: stolen ones are stopped
+  // without a tail first
+  jassert(slotOfVoice[(size_t)voice] < 0);
+
+  // Take the first free slot with a fresh oscillator and filter state
+  const auto slot = numActiveVoices++;
+  slotOfVoice[(size_t)voice] = slot;
+  voiceOfSlot[(size_t)slot] = voice;
+  voiceActive[(size_t)slot] = 1.0f;
+
+  filterS1[(size_t)slot] = 0.0f;
+  filterS2[(size_t)slot] = 0.0f;
+  filterG[(size_t)slot] = filterCoeffG;
+  filterR2[(size_t)slot] = filterCoeffR2;
+  filterH[(size_t)slot] = filterCoeffH;
+
+  envelopeLevel[(size_t)slot] = 0.0f;
+  updatePanGains(slot);
+
+  for (int index = 0; index < maxVoiceNotes; ++index) {
+    auto &layer = layers[(size_t)index];
+
+    if (index >= numNotes) {
+      layer.active[(size_t)slot] = 0.0f;
+      continue;
+    }
+
+    layer.oscA.phase[(size_t)slot] = 0.0f;
+    layer.oscB.phase[(size_t)slot] = 0.0f;
+    layer.active[(size_t)slot] = 1.0f;
+    setLayerNote(slot, index, midiNoteNumbers[(size_t)index]);
+  }
+  numLayers[(size_t)slot] = numNotes;
+
+  envelopeStage[(size_t)slot] = EnvelopeStage::Attack;
+  voiceQuietSamples[(size_t)slot] = 0;
+}
+
+void VoiceBank::stopVoice(int voice, bool allowTailOff) {
+  jassert(juce::isPositiveAndBelow(voice, numVoices));
+
+  auto slot = slotOfVoice[(size_t)voice];
+  if (slot < 0)
+    return;
+
+  const auto level = envelopeLevel[(size_t)slot];
+  if (!allowTailOff || level <= envelopeFreeLevel) {
+    removeSlot(slot);
+    return;
+  }
+
+  // A linear release takes the same time from any level
+  envelopeStage[(size_t)slot] = EnvelopeStage::Release;
+  envelopeReleaseOffset[(size_t)slot] = -level / releaseSamples;
+}
+
+void VoiceBank::removeVoiceNote(int voice, int noteIndex) {
+  jassert(juce::isPositiveAndBelow(voice, numVoices));
+
+  auto slot = slotOfVoice[(size_t)voice];
+  if (slot < 0)
+    return;
+
+  const auto s = (size_t)slot;
+  auto &count = numLayers[s];
+  jassert(count > 1 && juce::isPositiveAndBelow(noteIndex, count));
+  if (count <= 1 || !juce::isPositiveAndBelow(noteIndex, count))
+    return;
+
+  auto &last = layers[(size_t)(--count)];
+  auto &hole = layers[(size_t)noteIndex];
+
+  if (&hole != &last) {
+    for (auto member : {&OscillatorLayer::oscA, &OscillatorLayer::oscB}) {
+      auto &from = last.*member;
+      auto &to = hole.*member;
+      to.phase[s] = from.phase[s];
+      to.increment[s] = from.increment[s];
+      to.inverseIncrement[s] = from.inverseIncrement[s];
+      to.tables[s] = from.tables[s];
+    }
+  }
+
+  last.active[s] = 0.0f;
+}
+
+void VoiceBank::retargetVoiceNote(int voice, int noteIndex,
+                                  int midiNoteNumber) {
+  jassert(juce::isPositiveAndBelow(voice, numVoices));
+
+  auto slot = slotOfVoice[(size_t)voice];
+  if (slot < 0)
+    return;
+
+  jassert(juce::isPositiveAndBelow(noteIndex, numLayers[(size_t)slot]));
+  setLayerNote(slot, noteIndex, midiNoteNumber);
+}
+
+bool VoiceBank::isVoiceActive(int voice) const {
+  return slotOfVoice[(size_t)voice] >= 0;
+}
+
+void VoiceBank::moveSlot(int from, int to) {
+  const auto f = (size_t)from;
+  const auto t = (size_t)to;
+
+  for (auto &layer : layers) {
+    layer.active[t] = layer.active[f];
+    if (layer.active[t] <= 0.0f)
+      continue;
+
+    for (auto *osc : {&layer.oscA, &layer.oscB}) {
+      osc->phase[t] = osc->phase[f];
+      osc->increment[t] = osc->increment[f];
+      osc->inverseIncrement[t] = osc->inverseIncrement[f];
+      osc->tables[t] = osc->tables[f];
+    }
+  }
+  numLayers[t] = numLayers[f];
+
+  filterS1[t] = filterS1[f];
+  filterS2[t] = filterS2[f];
+  filterG[t] = filterG[f];
+  filterR2[t] = filterR2[f];
+  filterH[t] = filterH[f];
+  filterGStep[t] = filterGStep[f];
+  filterR2Step[t] = filterR2Step[f];
+  filterHStep[t] = filterHStep[f];
+  envelopeStage[t] = envelopeStage[f];
+  envelopeLevel[t] = envelopeLevel[f];
+  envelopeReleaseOffset[t] = envelopeReleaseOffset[f];
+  panLeft[t] = panLeft[f];
+  panRight[t] = panRight[f];
+  voicePeak[t] = voicePeak[f];
+  voiceQuietSamples[t] = voiceQuietSamples[f];
+
+  voiceOfSlot[t] = voiceOfSlot[f];
+  slotOfVoice[(size_t)voiceOfSlot[t]] = to;
+}
+
+void VoiceBank::removeSlot(int slot) {
+  jassert(juce::isPositiveAndBelow(slot, numActiveVoices));
+
+  slotOfVoice[(size_t)voiceOfSlot[(size_t)slot]] = -1;
+
+  // Keep the active slots contiguous by moving the last one into the hole
+  const int last = --numActiveVoices;
+  if (slot != last)
+    moveSlot(last, slot);
+
+  voiceOfSlot[(size_t)last] = -1;
+  voiceActive[(size_t)last] = 0.0f;
+  for (auto &layer : layers)
+    layer.active[(size_t)last] = 0.0f;
+  numLayers[(size_t)last] = 0;
+  envelopeStage[(size_t)last] = EnvelopeStage::Idle;
+}
+
+void VoiceBank::setParameters(const VoiceParameters &parameters) {
+  if (hasAppliedParameters && parameters.version == appliedVersion)
+    return;
+
+  // A skipped version hides which groups changed, so redo them all
+  auto dirty = hasAppliedParameters && parameters.version == appliedVersion + 1
+                   ? parameters.dirty
+                   : (std::uint32_t)VoiceParameters::allDirty;
+
+  // Nothing is audible to glide from on the first snapshot or when every
+  // voice is idle, so values jump straight to their targets
+  const bool jump = !hasAppliedParameters || numActiveVoices == 0;
+
+  hasAppliedParameters = true;
+  appliedVersion = parameters.version;
+
+  auto setTarget = [jump](auto &smoother, float target) {
+    if (jump)
+      smoother.setCurrentAndTargetValue(target);
+    else
+      smoother.setTargetValue(target);
+  };
+
+  if (dirty & VoiceParameters::oscillatorsDirty) {
+    auto updateOscillator = [&setTarget](
+                                OscillatorSettings &settings,
+                                const VoiceParameters::Oscillator &osc) {
+      settings.isEnabled = osc.isEnabled;
+      setTarget(settings.level, osc.level);
+
+      if (osc.rangeIndex == 0)
+        settings.frequencyMultiplier = 0.5f; // 16'
+      else if (osc.rangeIndex == 1)
+        settings.frequencyMultiplier = 1.0f; // 8'
+      else if (osc.rangeIndex == 2)
+        settings.frequencyMultiplier = 2.0f; // 4'
+
+      if (osc.waveform >= 0 && osc.waveform < VoiceBankKernels::numWaveforms)
+        settings.waveform = static_cast<Waveform>(osc.waveform);
+
+      settings.userTableIndex = osc.userTableIndex;
+    };
+
+    updateOscillator(settingsA, parameters.oscA);
+    updateOscillator(settingsB, parameters.oscB);
+  }
+
+  if (dirty & VoiceParameters::envelopeDirty) {
+    // Sounding voices pick the new segments up at the next chunk
+    envelopeSettings = parameters.envelope;
+    updateEnvelopeSegments();
+  }
+
+  if (dirty & VoiceParameters::filterDirty) {
+    setTarget(cutoffSmoother, parameters.filter.cutoff);
+    setTarget(resonanceSmoother, parameters.filter.resonance);
+    filterEnvelopeAmount = juce::jlimit(0.0f, 1.0f,
+                                        parameters.filter.envelopeAmount);
+
+    const bool wasEnabled = filterEnabled;
+    filterEnabled = parameters.filter.isEnabled;
+
+    // Ramps are set up per chunk. A jump only happens with no voice
+    // sounding, so the new coefficients are picked up by startVoice. A
+    // bypassed filter was left alone, so it restarts from silence.
+    if (jump || (filterEnabled && !wasEnabled))
+      resetFilter();
+  }
+}
+
+void VoiceBank::resetFilter() {
+  auto coefficients = makeFilterCoefficients(
+      cutoffSmoother.getCurrentValue(), resonanceSmoother.getCurrentValue(),
+      currentSampleRate);
+  filterCoeffG = coefficients.g;
+  filterCoeffR2 = coefficients.r2;
+  filterCoeffH = coefficients.h;
+
+  std::fill_n(filterG.begin(), numActiveVoices, filterCoeffG);
+  std::fill_n(filterR2.begin(), numActiveVoices, filterCoeffR2);
+  std::fill_n(filterH.begin(), numActiveVoices, filterCoeffH);
+  std::fill(filterGStep.begin(), filterGStep.end(), 0.0f);
+  std::fill(filterR2Step.begin(), filterR2Step.end(), 0.0f);
+  std::fill(filterHStep.begin(), filterHStep.end(), 0.0f);
+  std::fill_n(filterS1.begin(), numActiveVoices, 0.0f);
+  std::fill_n(filterS2.begin(), numActiveVoices, 0.0f);
+
+  filterRamping = false;
+  filterModulated = false;
+}
+
+// Returns true when the voices ramp independently, in which case the caller
+// moves each one to the end of its ramp once the chunk is rendered
+bool VoiceBank::updateFilterRamp(int numSamples, int numLanes) {
+  if (!filterEnabled) {
+    // Bypassed: keep the smoothers in time but leave the voices alone
+    cutoffSmoother.skip(numSamples);
+    resonanceSmoother.skip(numSamples);
+    return false;
+  }
+
+  const auto scale = 1.0f / static_cast<float>(numSamples);
+  const FilterCoefficients start{filterCoeffG, filterCoeffR2, filterCoeffH};
+  const bool smoothing =
+      cutoffSmoother.isSmoothing() || resonanceSmoother.isSmoothing();
+
+  if (smoothing) {
+    // One coefficient set per chunk, interpolated per sample by the kernel
+    auto end = makeFilterCoefficients(cutoffSmoother.skip(numSamples),
+                                      resonanceSmoother.skip(numSamples),
+                                      currentSampleRate);
+    filterCoeffG = end.g;
+    filterCoeffR2 = end.r2;
+    filterCoeffH = end.h;
+  }
+
+  if (filterEnvelopeAmount > 0.0f || filterModulated) {
+    // Each voice heads for the cutoff set by its envelope at the end of the
+    // chunk, from wherever the last chunk left it. Once the amount is back
+    // at zero, one more chunk glides every voice onto the shared values.
+    const auto cutoff = cutoffSmoother.getCurrentValue();
+    const auto resonance = resonanceSmoother.getCurrentValue();
+    const auto sweep =
+        std::log(juce::jmax(1.0f, maxFilterCutoff / cutoff)) *
+        filterEnvelopeAmount;
+    const auto *envelopeEnd =
+        envelopeScratch.data() + (size_t)((numSamples - 1) * numLanes);
+
+    if (!filterModulated) {
+      std::fill_n(filterG.begin(), numActiveVoices, start.g);
+      std::fill_n(filterR2.begin(), numActiveVoices, start.r2);
+      std::fill_n(filterH.begin(), numActiveVoices, start.h);
+    }
+
+    for (int slot = 0; slot < numActiveVoices; ++slot) {
+      const auto s = (size_t)slot;
+      auto end = sweep > 0.0f
+                     ? makeFilterCoefficients(
+                           cutoff * std::exp(sweep * envelopeEnd[s]),
+                           resonance, currentSampleRate)
+                     : FilterCoefficients{filterCoeffG, filterCoeffR2,
+                                          filterCoeffH};
+
+      filterGStep[s] = (end.g - filterG[s]) * scale;
+      filterR2Step[s] = (end.r2 - filterR2[s]) * scale;
+      filterHStep[s] = (end.h - filterH[s]) * scale;
+    }
+
+    filterModulated = filterEnvelopeAmount > 0.0f;
+    filterRamping = true; // Settle on the shared values afterwards
+    return true;
+  }
+
+  if (smoothing) {
+    std::fill_n(filterG.begin(), numActiveVoices, start.g);
+    std::fill_n(filterR2.begin(), numActiveVoices, start.r2);
+    std::fill_n(filterH.begin(), numActiveVoices, start.h);
+    std::fill_n(filterGStep.begin(), numActiveVoices,
+                (filterCoeffG - start.g) * scale);
+    std::fill_n(filterR2Step.begin(), numActiveVoices,
+                (filterCoeffR2 - start.r2) * scale);
+    std::fill_n(filterHStep.begin(), numActiveVoices,
+                (filterCoeffH - start.h) * scale);
+    filterRamping = true;
+  } else if (filterRamping) {
+    // Settle exactly on the target and stop stepping
+    std::fill_n(filterG.begin(), numActiveVoices, filterCoeffG);
+    std::fill_n(filterR2.begin(), numActiveVoices, filterCoeffR2);
+    std::fill_n(filterH.begin(), numActiveVoices, filterCoeffH);
+    std::fill(filterGStep.begin(), filterGStep.end(), 0.0f);
+    std::fill(filterR2Step.begin(), filterR2Step.end(), 0.0f);
+    std::fill(filterHStep.begin(), filterHStep.end(), 0.0f);
+    filterRamping = false;
+  }
+
+  return false;
+}
+
+void VoiceBank::EnvelopeSegmentArrays::assign(size_t size) {
+  multiplier.assign(size, 0.0f);
+  offset.assign(size, 0.0f);
+  floor.assign(size, 0.0f);
+  ceiling.assign(size, 0.0f);
+}
+
+void VoiceBank::EnvelopeSegmentArrays::set(
+    size_t slot, const EnvelopeSegmentValues &values) {
+  multiplier[slot] = values.multiplier;
+  offset[slot] = values.offset;
+  floor[slot] = values.floor;
+  ceiling[slot] = values.ceiling;
+}
+
+VoiceBankKernels::EnvelopeSegment
+VoiceBank::EnvelopeSegmentArrays::get() const {
+  return {multiplier.data(), offset.data(), floor.data(), ceiling.data()};
+}
+
+void VoiceBank::updateEnvelopeSegments() {
+  auto toSamples = [this](float seconds) {
+    return juce::jmax(1.0, static_cast<double>(seconds) * currentSampleRate);
+  };
+
+  const auto attack = toSamples(envelopeSettings.attack);
+  const auto decay = toSamples(envelopeSettings.decay);
+  const auto sustain = juce::jlimit(0.0f, 1.0f, envelopeSettings.sustain);
+  releaseSamples = static_cast<float>(toSamples(envelopeSettings.release));
+
+  if (envelopeSettings.exponential) {
+    // Each stage closes all but envelopeFreeLevel of its distance in its
+    // time, except the attack, which reaches full scale on time
+    constexpr auto target = exponentialAttackTarget;
+    const auto attackMultiplier = std::pow((target - 1.0) / target,
+                                           1.0 / attack);
+    const auto decayMultiplier =
+        std::pow(static_cast<double>(envelopeFreeLevel), 1.0 / decay);
+
+    attackSegment = {static_cast<float>(attackMultiplier),
+                     static_cast<float>(target * (1.0 - attackMultiplier)),
+                     0.0f, 1.0f};
+    decaySegment = {static_cast<float>(decayMultiplier),
+                    static_cast<float>(sustain * (1.0 - decayMultiplier)),
+                    sustain, 1.0f};
+    releaseSegment = {static_cast<float>(std::pow(
+                          static_cast<double>(envelopeFreeLevel),
+                          1.0 / static_cast<double>(releaseSamples))),
+                      0.0f, 0.0f, 1.0f};
+  } else {
+    // Same rates as juce::ADSR
+    attackSegment = {1.0f, static_cast<float>(1.0 / attack), 0.0f, 1.0f};
+    decaySegment = {1.0f, static_cast<float>((sustain - 1.0) / decay),
+                    sustain, 1.0f};
+    releaseSegment = {1.0f, 0.0f, 0.0f, 1.0f}; // Offset set per voice
+  }
+
+  // Follows sustain changes straight away, like juce::ADSR
+  sustainSegment = {0.0f, sustain, 0.0f, 1.0f};
+}
+
+void VoiceBank::renderEnvelopes(const VoiceBankKernels::ChunkLayout &layout) {
+  for (int slot = 0; slot < numActiveVoices; ++slot) {
+    const auto s = (size_t)slot;
+    auto segment = sustainSegment;
+    auto nextSegment = sustainSegment;
+    auto switchLevel = VoiceBankKernels::noSwitchLevel;
+
+    switch (envelopeStage[s]) {
+    case EnvelopeStage::Attack:
+      // The only stage that can hand over inside a chunk
+      segment = attackSegment;
+      nextSegment = decaySegment;
+      switchLevel = 1.0f;
+      break;
+    case EnvelopeStage::Decay:
+      segment = nextSegment = decaySegment;
+      break;
+    case EnvelopeStage::Release:
+      segment = releaseSegment;
+      if (!envelopeSettings.exponential)
+        segment.offset = envelopeReleaseOffset[s];
+      nextSegment = segment;
+      break;
+    case EnvelopeStage::Idle:
+      // Finished earlier in this render call; silent until retired
+      segment = nextSegment = {};
+      break;
+    case EnvelopeStage::Sustain:
+      break;
+    }
+
+    envelopeSegment.set(s, segment);
+    envelopeNextSegment.set(s, nextSegment);
+    envelopeSwitchLevel[s] = switchLevel;
+  }
+
+  const VoiceBankKernels::EnvelopeBlock block{
+      envelopeLevel.data(),        envelopeSegment.get(),
+      envelopeNextSegment.get(),   envelopeSwitchLevel.data(),
+      envelopeSwitched.data(),     envelopeScratch.data()};
+
+  kernels.renderEnvelope(layout, block);
+
+  // Stage changes the segments leave implicit
+  const auto sustainLevel = sustainSegment.offset + envelopeFreeLevel;
+  for (int slot = 0; slot < numActiveVoices; ++slot) {
+    const auto s = (size_t)slot;
+    auto &stage = envelopeStage[s];
+
+    if (stage == EnvelopeStage::Attack && envelopeSwitched[s] > 0.0f)
+      stage = EnvelopeStage::Decay;
+
+    if (stage == EnvelopeStage::Decay && envelopeLevel[s] <= sustainLevel)
+      stage = EnvelopeStage::Sustain;
+    else if (stage == EnvelopeStage::Release &&
+             envelopeLevel[s] <= envelopeFreeLevel)
+      stage = EnvelopeStage::Idle;
+  }
+}
+
+void VoiceBank::setStereoSpread(float spread) {
+  spread = juce::jlimit(0.0f, 1.0f, spread);
+  if (!std::islessgreater(spread, stereoSpread))
+    return;
+
+  stereoSpread = spread;
+  for (int slot = 0; slot < numActiveVoices; ++slot)
+    updatePanGains(slot);
+}
+
+void VoiceBank::updatePanGains(int slot) {
+  // Balance law: a centred voice stays at unity on both sides, matching the
+  // mono mix, and the far side fades out as the voice moves away
+  auto voice = (size_t)voiceOfSlot[(size_t)slot];
+  auto position =
+      voicePanPositions[voice % voicePanPositions.size()] * stereoSpread;
+
+  panLeft[(size_t)slot] = juce::jmin(1.0f, 1.0f - position);
+  panRight[(size_t)slot] = juce::jmin(1.0f, 1.0f + position);
+}
+
+VoiceBank::Waveform VoiceBank::prepareTables(const OscillatorSettings &settings,
+                                             OscillatorState &state,
+                                             const float *active) {
+  auto waveform = settings.waveform;
+
+  if (waveform == Waveform::SawTable || waveform == Waveform::SquareTable) {
+    auto shape = waveform == Waveform::SawTable ? WavetableBank::Shape::Saw
+                                                : WavetableBank::Shape::Square;
+
+    for (int slot = 0; slot < numActiveVoices; ++slot)
+      if (active[slot] > 0.0f)
+        state.tables[(size_t)slot] = bank.getTable(
+            shape, WavetableBank::getLevelForIncrement(
+                       state.increment[(size_t)slot]));
+  } else if (waveform == Waveform::User) {
+    // User tables play as a sine until their mip levels have been built. All
+    // levels of a table are published together, so one lookup decides.
+    if (library.getTable(settings.userTableIndex, 0) == nullptr)
+      return Waveform::Sine;
+
+    for (int slot = 0; slot < numActiveVoices; ++slot)
+      if (active[slot] > 0.0f)
+        state.tables[(size_t)slot] = library.getTable(
+            settings.userTableIndex, WavetableBank::getLevelForIncrement(
+                                         state.increment[(size_t)slot]));
+  }
+
+  return waveform;
+}
+
+void VoiceBank::renderChunk(int numSamples, int numLanes, int numLayersInUse,
+                            bool stereo) {
+  const VoiceBankKernels::ChunkLayout layout{
+      numSamples, numLanes, voiceActive.data(), mixScratch.data()};
+
+  renderEnvelopes(layout);
+
+  // The filter envelope follows the levels just computed
+  const bool perVoiceFilterRamp = updateFilterRamp(numSamples, numLanes);
+
+  // The first oscillator rendered replaces the mix, the others add to it.
+  // Each layer only runs the lanes of voices with that many notes.
+  bool mixWritten = false;
+  for (auto [settings, member] :
+       {std::pair{&settingsA, &OscillatorLayer::oscA},
+        std::pair{&settingsB, &OscillatorLayer::oscB}}) {
+    // Advance the level ramp even while disabled, to stay in time
+    const auto levelStart = settings->level.getCurrentValue();
+    const auto levelEnd = settings->level.skip(numSamples);
+
+    if (!settings->isEnabled)
+      continue;
+
+    for (int index = 0; index < numLayersInUse; ++index) {
+      auto &layer = layers[(size_t)index];
+      auto &state = layer.*member;
+
+      const VoiceBankKernels::ChunkLayout layerLayout{
+          numSamples, numLanes, layer.active.data(), mixScratch.data()};
+
+      const VoiceBankKernels::OscillatorBlock block{
+          prepareTables(*settings, state, layer.active.data()),
+          levelStart,
+          (levelEnd - levelStart) / static_cast<float>(numSamples),
+          mixWritten,
+          state.phase.data(),
+          state.increment.data(),
+          state.inverseIncrement.data(),
+          state.tables.data()};
+
+      kernels.renderOscillator(layerLayout, block);
+      mixWritten = true;
+    }
+  }
+
+  if (!mixWritten)
+    std::fill_n(mixScratch.begin(), numSamples * numLanes, 0.0f);
+
+  const VoiceBankKernels::PostBlock post{filterS1.data(),
+                                         filterS2.data(),
+                                         filterG.data(),
+                                         filterR2.data(),
+                                         filterH.data(),
+                                         filterGStep.data(),
+                                         filterR2Step.data(),
+                                         filterHStep.data(),
+                                         filterEnabled,
+                                         envelopeScratch.data(),
+                                         masterGain,
+                                         stereo ? panLeft.data() : nullptr,
+                                         stereo ? panRight.data() : nullptr,
+                                         leftChunk.data(),
+                                         rightChunk.data(),
+                                         voicePeak.data()};
+
+  kernels.renderPost(layout, post);
+  cullSilentVoices(numSamples);
+
+  if (perVoiceFilterRamp) {
+    const auto n = static_cast<float>(numSamples);
+    for (size_t slot = 0; slot < (size_t)numActiveVoices; ++slot) {
+      filterG[slot] += filterGStep[slot] * n;
+      filterR2[slot] += filterR2Step[slot] * n;
+      filterH[slot] += filterHStep[slot] * n;
+    }
+  }
+}
+
+void VoiceBank::cullSilentVoices(int numSamples) {
+  // Only voices whose envelope cannot rise again without a new note-on
+  const bool sustainSilent = sustainSegment.offset <= envelopeFreeLevel;
+
+  for (int slot = 0; slot < numActiveVoices; ++slot) {
+    const auto s = (size_t)slot;
+    auto &quiet = voiceQuietSamples[s];
+    quiet = voicePeak[s] < cullPeakLevel ? quiet + numSamples : 0;
+
+    const auto stage = envelopeStage[s];
+    const bool canCull =
+        stage == EnvelopeStage::Release ||
+        (sustainSilent && stage != EnvelopeStage::Attack);
+
+    // Silent from here on; retired at the end of render()
+    if (quiet >= cullHoldSamples && canCull)
+      envelopeStage[s] = EnvelopeStage::Idle;
+  }
+}
+
+void VoiceBank::render(juce::AudioBuffer<float> &outputBuffer,
+                       int startSample, int numSamples) {
+  finishedVoices.clear();
+
+  if (numActiveVoices == 0)
+    return;
+
+  // Without spread one mono mix feeds every channel; with it, even channels
+  // take the left mix and odd channels the right
+  const bool stereo =
+      stereoSpread > 0.0f && outputBuffer.getNumChannels() > 1;
+  const int numLanes = getNumLanes(numActiveVoices);
+  const int numLayersInUse = *std::max_element(
+      numLayers.begin(), numLayers.begin() + numActiveVoices);
+
+  while (numSamples > 0) {
+    const int chunk = juce::jmin(numSamples, VoiceBankKernels::maxChunkSize);
+    renderChunk(chunk, numLanes, numLayersInUse, stereo);
+
+    for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel) {
+      const auto &mix = stereo && channel % 2 == 1 ? rightChunk : leftChunk;
+      outputBuffer.addFrom(channel, startSample, mix.data(), chunk);
+    }
+
+    startSample += chunk;
+    numSamples -= chunk;
+  }
+
+  // Retire voices whose release has finished (walking down, so the slot moved
+  // into a hole has already been checked), and keep denormals out of the
+  // filter state
+  for (int slot = numActiveVoices - 1; slot >= 0; --slot) {
+    for (auto *state : {&filterS1[(size_t)slot], &filterS2[(size_t)slot]})
+      if (std::abs(*state) < 1.0e-8f)
+        *state = 0.0f;
+
+    if (envelopeStage[(size_t)slot] == EnvelopeStage::Idle) {
+      finishedVoices.push_back(voiceOfSlot[(size_t)slot]);
+      removeSlot(slot);
+    }
+  }
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "VoiceBankKernels.h"
+#include "VoiceParameters.h"
+#include "WavetableBank.h"
+#include "WavetableLibrary.h"
+#include <JuceHeader.h>
+#include <span>
+
+// DSP state for every voice, stored struct-of-arrays (one array per field,
+// indexed by slot) and rendered several voices at a time: one voice per
+// vector lane, using the widest kernel set the CPU supports (AVX, then
+// SSE2/NEON, then scalar). Every kernel set runs the same per-voice chain:
+//
+//   (oscA * levelA + oscB * levelB) -> SVF low-pass -> ADSR -> master gain
+//
+// so switching instruction set changes the speed, not the sound. Voices are
+// rendered in mono; the optional stereo spread is a per-voice gain pair
+// applied while mixing.
+//
+// The ADSR is a vector kernel too: each stage is a linear or exponential
+// segment evaluated for every voice at once, and the stage machine only runs
+// between chunks. A released voice is freed as soon as its level falls below
+// envelopeFreeLevel, or once its output has stayed below -120 dB for a short
+// while (e.g. behind a closed filter).
+//
+// Oscillator levels, cutoff and resonance glide to new values. They are
+// advanced once per chunk and ramped linearly inside it, so the filter costs
+// one tan per chunk at most. Chunks are at most maxChunkSize (32) samples;
+// renders are also cut at MIDI events and block ends, so the values move at
+// least every 32 samples and more often around events. The filter envelope
+// raises each voice's cutoff towards the top of the range by its own ADSR
+// level, sampled once per chunk too (one tan per voice per chunk). A disabled
+// filter is skipped by the kernels.
+//
+// A voice can play several notes at once (a chord voice): each note gets its
+// own oscillator layer, and the layers are summed before the voice's single
+// filter and envelope. That costs one oscillator pair per note but one post
+// chain per chord, and, the filter being linear, sounds the same as the notes
+// on separate voices started together.
+//
+// VoiceManager decides which voice plays which notes and addresses voices by
+// index.
+//
+// Sounding voices are kept packed at the front of the arrays (slots
+// 0 .. numActiveVoices - 1): a starting voice takes the next free slot and a
+// finished one is replaced by the last active slot. Rendering and parameter
+// updates only walk that prefix, so idle voices cost nothing.
+class VoiceBank {
+public:
+  // Largest voice pool prepare() accepts
+  static constexpr int maxVoices = 128;
+  // Most notes one voice can play
+  static constexpr int maxVoiceNotes = 16;
+  // -120 dB; a releasing voice below this is finished. Exponential stage
+  // times are measured to this level too.
+  static constexpr float envelopeFreeLevel = 1.0e-6f;
+
+  VoiceBank(const WavetableBank &wavetableBank,
+            WavetableLibrary &wavetableLibrary);
+
+  // Allocates every per-voice array; nothing is allocated while rendering
+  void prepare(double sampleRate, int numVoices);
+
+  // Starts a voice that is not sounding, one oscillator layer per note in the
+  // order given
+  void startVoice(int voice, std::span<const int> midiNoteNumbers);
+  // Silences one note of a voice that keeps playing its others. The last
+  // note moves into its place, so later indices shift like swap-and-pop.
+  void removeVoiceNote(int voice, int noteIndex);
+  // Moves one note of a sounding voice to a new pitch, keeping its phase and
+  // the voice's envelope (legato)
+  void retargetVoiceNote(int voice, int noteIndex, int midiNoteNumber);
+  void stopVoice(int voice, bool allowTailOff);
+  bool isVoiceActive(int voice) const;
+  int getNumActiveVoices() const { return numActiveVoices; }
+
+  // Applies only the groups marked dirty since the last snapshot seen;
+  // returns straight away when the version has not moved
+  void setParameters(const VoiceParameters &parameters);
+
+  // 0 renders every voice centred (a single mono mix copied to each
+  // channel); 1 spreads voices across the full stereo width by voice index
+  void setStereoSpread(float spread);
+
+  // Adds every active voice to all channels of outputBuffer
+  void render(juce::AudioBuffer<float> &outputBuffer, int startSample,
+              int numSamples);
+
+  // Voices whose release ended during the last render() call
+  std::span<const int> getFinishedVoices() const {
+    return {finishedVoices.data(), finishedVoices.size()};
+  }
+
+private:
+  using Waveform = VoiceBankKernels::Waveform;
+
+  struct OscillatorSettings {
+    Waveform waveform{Waveform::Sine};
+    int userTableIndex{0};
+    float frequencyMultiplier{1.0f};
+    bool isEnabled{true};
+    juce::SmoothedValue<float> level;
+  };
+
+  enum class EnvelopeStage : std::uint8_t {
+    Idle,
+    Attack,
+    Decay,
+    Sustain,
+    Release
+  };
+
+  struct EnvelopeSegmentValues {
+    float multiplier, offset, floor, ceiling;
+  };
+
+  // Per-slot segment arrays, refilled from the stages before each chunk
+  struct EnvelopeSegmentArrays {
+    std::vector<float> multiplier, offset, floor, ceiling;
+
+    void assign(size_t size);
+    void set(size_t slot, const EnvelopeSegmentValues &values);
+    VoiceBankKernels::EnvelopeSegment get() const;
+  };
+
+  struct OscillatorState {
+    std::vector<float> phase;
+    std::vector<float> increment;
+    std::vector<float> inverseIncrement;
+    std::vector<const float *> tables;
+  };
+
+  // The oscillators for one note of each voice
+  struct OscillatorLayer {
+    OscillatorState oscA;
+    OscillatorState oscB;
+    std::vector<float> active; // Per slot, like voiceActive
+  };
+
+  void setFrequency(OscillatorState &state, int slot, float frequencyHz);
+  void setLayerNote(int slot, int noteIndex, int midiNoteNumber);
+  void updatePanGains(int slot);
+  void updateEnvelopeSegments();
+  void renderEnvelopes(const VoiceBankKernels::ChunkLayout &layout);
+  void cullSilentVoices(int numSamples);
+  void moveSlot(int from, int to);
+  void removeSlot(int slot);
+  Waveform prepareTables(const OscillatorSettings &settings,
+                         OscillatorState &state, const float *active);
+  void resetFilter();
+  bool updateFilterRamp(int numSamples, int numLanes);
+  void renderChunk(int numSamples, int numLanes, int numLayersInUse,
+                   bool stereo);
+
+  const WavetableBank &bank;
+  WavetableLibrary &library;
+  VoiceBankKernels::KernelTable kernels{};
+
+  double currentSampleRate{44100.0};
+  int numVoices{0};
+  int numActiveVoices{0};
+
+  OscillatorSettings settingsA;
+  OscillatorSettings settingsB{Waveform::Sine, 0, 1.0f, false, {}};
+  VoiceParameters::Envelope envelopeSettings;
+  // Shared by every voice; a linear release also has a per-voice offset
+  EnvelopeSegmentValues attackSegment{}, decaySegment{}, sustainSegment{},
+      releaseSegment{};
+  float releaseSamples{1.0f};
+  int cullHoldSamples{0};
+  // Coefficients at the current chunk boundary
+  float filterCoeffG{0.0f}, filterCoeffR2{1.0f}, filterCoeffH{1.0f};
+  bool filterRamping{false};
+  bool filterEnabled{true};
+  float filterEnvelopeAmount{0.0f};
+  bool filterModulated{false}; // Voices may sit off the shared coefficients
+
+  juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>
+      cutoffSmoother;
+  juce::SmoothedValue<float> resonanceSmoother;
+  float stereoSpread{0.0f};
+
+  bool hasAppliedParameters{false};
+  std::uint32_t appliedVersion{0};
+
+  // Voice index <-> slot; -1 marks an idle voice
+  std::vector<int> slotOfVoice;
+  std::vector<int> voiceOfSlot;
+  std::vector<int> finishedVoices;
+
+  // Per-slot state
+  std::array<OscillatorLayer, maxVoiceNotes> layers;
+  std::vector<int> numLayers;
+  std::vector<float> filterS1, filterS2;
+  std::vector<float> filterG, filterR2, filterH;
+  std::vector<float> filterGStep, filterR2Step, filterHStep;
+  std::vector<EnvelopeStage> envelopeStage;
+  std::vector<float> envelopeLevel;
+  std::vector<float> envelopeReleaseOffset;
+  EnvelopeSegmentArrays envelopeSegment, envelopeNextSegment;
+  std::vector<float> envelopeSwitchLevel, envelopeSwitched;
+  std::vector<float> panLeft, panRight;
+  std::vector<float> voicePeak;       // Output peak of the last chunk
+  std::vector<int> voiceQuietSamples; // Run of samples below cullPeakLevel
+  std::vector<float> voiceActive; // 1 or 0, see VoiceBankKernels::ChunkLayout
+
+  // Chunk scratch, [sample * lanes + slot]
+  std::vector<float> mixScratch;
+  std::vector<float> envelopeScratch;
+  std::array<float, VoiceBankKernels::maxChunkSize> leftChunk{};
+  std::array<float, VoiceBankKernels::maxChunkSize> rightChunk{};
+
+  static constexpr float masterGain = 0.3f;
+  static constexpr float maxFilterCutoff = 20000.0f;
+  static constexpr double smoothingTimeSeconds = 0.02;
+  // A voice is culled after its output peak stays under -120 dB for the hold
+  // time, long enough to span a half cycle of the lowest notes
+  static constexpr float cullPeakLevel = 1.0e-6f;
+  static constexpr double cullHoldSeconds = 0.05;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoiceBank)
+};
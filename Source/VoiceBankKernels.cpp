@@ -0,0 +1,143 @@
+#include "VoiceBankKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define MYSYNTH_KERNELS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define MYSYNTH_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+struct ScalarVec {
+  static constexpr int width = 1;
+  using Mask = bool;
+
+  float value;
+
+  static ScalarVec broadcast(float v) { return {v}; }
+  static ScalarVec load(const float *source) { return {*source}; }
+  void store(float *dest) const { *dest = value; }
+
+  friend ScalarVec operator+(ScalarVec a, ScalarVec b) {
+    return {a.value + b.value};
+  }
+  friend ScalarVec operator-(ScalarVec a, ScalarVec b) {
+    return {a.value - b.value};
+  }
+  friend ScalarVec operator*(ScalarVec a, ScalarVec b) {
+    return {a.value * b.value};
+  }
+
+  static ScalarVec min(ScalarVec a, ScalarVec b) {
+    return a.value < b.value ? a : b;
+  }
+  static ScalarVec max(ScalarVec a, ScalarVec b) {
+    return b.value < a.value ? a : b;
+  }
+
+  static Mask lessThan(ScalarVec a, ScalarVec b) { return a.value < b.value; }
+  static Mask lessThanOrEqual(ScalarVec a, ScalarVec b) {
+    return a.value <= b.value;
+  }
+  static ScalarVec select(Mask m, ScalarVec a, ScalarVec b) {
+    return m ? a : b;
+  }
+};
+
+#if MYSYNTH_KERNELS_SSE2
+struct SSE2Vec {
+  static constexpr int width = 4;
+  using Mask = __m128;
+
+  __m128 value;
+
+  static SSE2Vec broadcast(float v) { return {_mm_set1_ps(v)}; }
+  static SSE2Vec load(const float *source) { return {_mm_loadu_ps(source)}; }
+  void store(float *dest) const { _mm_storeu_ps(dest, value); }
+
+  friend SSE2Vec operator+(SSE2Vec a, SSE2Vec b) {
+    return {_mm_add_ps(a.value, b.value)};
+  }
+  friend SSE2Vec operator-(SSE2Vec a, SSE2Vec b) {
+    return {_mm_sub_ps(a.value, b.value)};
+  }
+  friend SSE2Vec operator*(SSE2Vec a, SSE2Vec b) {
+    return {_mm_mul_ps(a.value, b.value)};
+  }
+
+  static SSE2Vec min(SSE2Vec a, SSE2Vec b) {
+    return {_mm_min_ps(a.value, b.value)};
+  }
+  static SSE2Vec max(SSE2Vec a, SSE2Vec b) {
+    return {_mm_max_ps(a.value, b.value)};
+  }
+
+  static Mask lessThan(SSE2Vec a, SSE2Vec b) {
+    return _mm_cmplt_ps(a.value, b.value);
+  }
+  static Mask lessThanOrEqual(SSE2Vec a, SSE2Vec b) {
+    return _mm_cmple_ps(a.value, b.value);
+  }
+  static SSE2Vec select(Mask m, SSE2Vec a, SSE2Vec b) {
+    return {_mm_or_ps(_mm_and_ps(m, a.value), _mm_andnot_ps(m, b.value))};
+  }
+};
+#endif
+
+#if MYSYNTH_KERNELS_NEON
+struct NEONVec {
+  static constexpr int width = 4;
+  using Mask = uint32x4_t;
+
+  float32x4_t value;
+
+  static NEONVec broadcast(float v) { return {vdupq_n_f32(v)}; }
+  static NEONVec load(const float *source) { return {vld1q_f32(source)}; }
+  void store(float *dest) const { vst1q_f32(dest, value); }
+
+  friend NEONVec operator+(NEONVec a, NEONVec b) {
+    return {vaddq_f32(a.value, b.value)};
+  }
+  friend NEONVec operator-(NEONVec a, NEONVec b) {
+    return {vsubq_f32(a.value, b.value)};
+  }
+  friend NEONVec operator*(NEONVec a, NEONVec b) {
+    return {vmulq_f32(a.value, b.value)};
+  }
+
+  static NEONVec min(NEONVec a, NEONVec b) {
+    return {vminq_f32(a.value, b.value)};
+  }
+  static NEONVec max(NEONVec a, NEONVec b) {
+    return {vmaxq_f32(a.value, b.value)};
+  }
+
+  static Mask lessThan(NEONVec a, NEONVec b) {
+    return vcltq_f32(a.value, b.value);
+  }
+  static Mask lessThanOrEqual(NEONVec a, NEONVec b) {
+    return vcleq_f32(a.value, b.value);
+  }
+  static NEONVec select(Mask m, NEONVec a, NEONVec b) {
+    return {vbslq_f32(m, a.value, b.value)};
+  }
+};
+#endif
+} // namespace
+
+namespace VoiceBankKernels {
+
+KernelTable getScalarKernels() { return makeKernelTable<ScalarVec>(); }
+
+KernelTable getBaselineKernels() {
+#if MYSYNTH_KERNELS_SSE2
+  return makeKernelTable<SSE2Vec>();
+#elif MYSYNTH_KERNELS_NEON
+  return makeKernelTable<NEONVec>();
+#else
+  return getScalarKernels();
+#endif
+}
+
+} // namespace VoiceBankKernels
@@ -0,0 +1,479 @@
+#pragma once
+
+// Render kernels for VoiceBank, written once against a small vector type
+// and instantiated per instruction set (scalar, SSE2/NEON and AVX). Voice
+// state is stored struct-of-arrays so one vector lane holds one voice.
+//
+// This header must stay free of JUCE and of non-template inline functions:
+// the AVX translation unit is compiled with AVX enabled, and any inline
+// function shared with the baseline units could be merged by the linker
+// into code that runs on CPUs without AVX. Everything below is either a
+// template (instantiated with a vector type local to each unit) or static.
+
+namespace VoiceBankKernels {
+
+// Order matches the oscType/oscBType choice parameters
+enum class Waveform {
+  Sine = 0,
+  Saw,
+  Square,
+  SawBLEP,
+  SquareBLEP,
+  SawTable,
+  SquareTable,
+  User
+};
+static constexpr int numWaveforms = 8;
+
+// Samples processed per kernel call; also the scratch height
+static constexpr int maxChunkSize = 32;
+// Widest vector (AVX); voice arrays are padded to a multiple of this
+static constexpr int maxWidth = 8;
+// Length of one single-cycle wavetable (see WavetableBank)
+static constexpr int wavetableSize = 2048;
+// EnvelopeBlock::switchLevel of a segment that never ends in a chunk; above
+// any level an envelope can reach
+static constexpr float noSwitchLevel = 2.0f;
+
+// Scratch layout shared by every kernel call of a chunk
+struct ChunkLayout {
+  int numSamples; // <= maxChunkSize
+  int numVoices;  // Padded to a multiple of maxWidth
+  // 1 for playing voices, 0 otherwise; float so it loads as a lane mask.
+  // Silent lanes keep their phase and filter state untouched, so a voice
+  // renders the same samples whichever vector width it shares a group with.
+  const float *voiceActive;
+  float *mix; // [sample * numVoices + voice], oscillator sum before the filter
+};
+
+struct OscillatorBlock {
+  Waveform waveform;
+  float level;     // At the first sample of the chunk
+  float levelStep; // Added per sample, for ramps across the chunk
+  bool accumulate; // Add to the mix instead of replacing it
+  float *phase;    // Normalised [0, 1), advanced in place
+  const float *increment;
+  const float *inverseIncrement; // 0 for stopped oscillators
+  const float *const *tables;    // Per-voice mip level for table waveforms
+};
+
+// One envelope segment per voice. The level follows
+//
+//   level = min(max(level * multiplier + offset, floor), ceiling)
+//
+// which is a linear ramp when multiplier is 1 and an exponential approach to
+// offset / (1 - multiplier) otherwise, clamped to the segment's range.
+struct EnvelopeSegment {
+  const float *multiplier;
+  const float *offset;
+  const float *floor;
+  const float *ceiling;
+};
+
+struct EnvelopeBlock {
+  float *level; // Advanced in place
+  EnvelopeSegment segment;
+  // A voice whose level reaches switchLevel continues with nextSegment from
+  // the following sample, so an attack can end inside a chunk. Other stage
+  // changes are left to the caller between chunks.
+  EnvelopeSegment nextSegment;
+  const float *switchLevel;
+  float *switched; // Set to 1 for voices that moved to nextSegment, else 0
+  float *output;   // [sample * numVoices + voice], 0 for inactive voices
+};
+
+struct PostBlock {
+  // State variable TPT low-pass, same topology as
+  // juce::dsp::StateVariableTPTFilter. Coefficients are given for the first
+  // sample and move linearly by their step every sample.
+  float *s1;
+  float *s2;
+  const float *g;
+  const float *r2;
+  const float *h;
+  const float *gStep;
+  const float *r2Step;
+  const float *hStep;
+  bool filterEnabled; // When false the filter is skipped and left untouched
+  const float *envelope; // [sample * numVoices + voice]
+  float gain;
+  // Per-voice stereo gains, or null for a mono mix
+  const float *panLeft;
+  const float *panRight;
+  float *output;      // Mono (or left) mix, numSamples values (replaced)
+  float *outputRight; // Right mix when panning, otherwise unused
+  float *peak;        // Per voice: largest |output| in the chunk, before pan
+};
+
+// Kept trivial (no default member initialisers) so no constructor is emitted
+// from the AVX unit; value-initialise with KernelTable{} instead
+struct KernelTable {
+  int width; // 0 when the instruction set is not available
+  void (*renderEnvelope)(const ChunkLayout &, const EnvelopeBlock &);
+  void (*renderOscillator)(const ChunkLayout &, const OscillatorBlock &);
+  void (*renderPost)(const ChunkLayout &, const PostBlock &);
+};
+
+// One voice per call, no intrinsics. Reference for the vector versions.
+KernelTable getScalarKernels();
+// SSE2 on x86, NEON on ARM64; falls back to scalar elsewhere
+KernelTable getBaselineKernels();
+// Needs a CPU check before use; width is 0 if AVX was not compiled in
+KernelTable getAVXKernels();
+
+//==============================================================================
+// Kernel templates. Vec provides width, broadcast, load/store (unaligned),
+// + - *, min/max, lessThan/lessThanOrEqual masks and select.
+
+template <typename Vec> static Vec sineFromPhase(Vec phase) {
+  // sin(2 * pi * phase - pi), folded into [-pi/2, pi/2] and evaluated with
+  // a degree-11 Taylor polynomial (error < 1e-7)
+  const auto half = Vec::broadcast(0.5f);
+  const auto quarter = Vec::broadcast(0.25f);
+  const auto minusHalf = Vec::broadcast(-0.5f);
+  const auto minusQuarter = Vec::broadcast(-0.25f);
+
+  auto u = phase - half;
+  u = Vec::select(Vec::lessThan(quarter, u), half - u, u);
+  u = Vec::select(Vec::lessThan(u, minusQuarter), minusHalf - u, u);
+
+  auto x = u * Vec::broadcast(6.283185307179586f);
+  auto x2 = x * x;
+
+  auto poly = Vec::broadcast(-2.5052108385441718775e-8f);
+  poly = Vec::broadcast(2.7557319223985890653e-6f) + x2 * poly;
+  poly = Vec::broadcast(-1.9841269841269841270e-4f) + x2 * poly;
+  poly = Vec::broadcast(8.3333333333333333333e-3f) + x2 * poly;
+  poly = Vec::broadcast(-1.6666666666666666667e-1f) + x2 * poly;
+
+  return x + x * x2 * poly;
+}
+
+// Two-sample polynomial band-limited step residual (PolyBLEP)
+template <typename Vec> static Vec polyBlep(Vec t, Vec dt, Vec invDt) {
+  const auto one = Vec::broadcast(1.0f);
+
+  auto a = t * invDt;
+  auto afterStep = a + a - a * a - one;
+
+  auto b = (t - one) * invDt;
+  auto beforeStep = b * b + b + b + one;
+
+  return Vec::select(
+      Vec::lessThan(t, dt), afterStep,
+      Vec::select(Vec::lessThan(one - dt, t), beforeStep,
+                  Vec::broadcast(0.0f)));
+}
+
+// Linear interpolation into each lane's own table; inactive lanes may have
+// no table and read as silence
+template <typename Vec>
+static Vec readTables(Vec phase, const float *const *tables) {
+  float phases[maxWidth];
+  float samples[maxWidth];
+  phase.store(phases);
+
+  for (int lane = 0; lane < Vec::width; ++lane) {
+    const float *table = tables[lane];
+    if (table == nullptr) {
+      samples[lane] = 0.0f;
+      continue;
+    }
+
+    float position = phases[lane] * static_cast<float>(wavetableSize);
+    int index = static_cast<int>(position);
+    float frac = position - static_cast<float>(index);
+    samples[lane] = table[index] + frac * (table[index + 1] - table[index]);
+  }
+
+  return Vec::load(samples);
+}
+
+template <typename Vec, Waveform W>
+static Vec oscillatorSample(Vec phase, Vec dt, Vec invDt,
+                            const float *const *tables) {
+  if constexpr (W == Waveform::Sine) {
+    return sineFromPhase(phase);
+  } else if constexpr (W == Waveform::Saw) {
+    // Naive Sawtooth
+    return phase + phase - Vec::broadcast(1.0f);
+  } else if constexpr (W == Waveform::Square) {
+    // Naive Square
+    return Vec::select(Vec::lessThan(phase, Vec::broadcast(0.5f)),
+                       Vec::broadcast(-1.0f), Vec::broadcast(1.0f));
+  } else if constexpr (W == Waveform::SawBLEP) {
+    // Falling step at the wrap point
+    return phase + phase - Vec::broadcast(1.0f) - polyBlep(phase, dt, invDt);
+  } else if constexpr (W == Waveform::SquareBLEP) {
+    // Falling step at the wrap point, rising step half a cycle later
+    const auto one = Vec::broadcast(1.0f);
+    auto halfPhase = phase + Vec::broadcast(0.5f);
+    halfPhase =
+        Vec::select(Vec::lessThanOrEqual(one, halfPhase), halfPhase - one,
+                    halfPhase);
+
+    auto naive = Vec::select(Vec::lessThan(phase, Vec::broadcast(0.5f)),
+                             Vec::broadcast(-1.0f), one);
+    return naive - polyBlep(phase, dt, invDt) +
+           polyBlep(halfPhase, dt, invDt);
+  } else {
+    // SawTable, SquareTable and User all read from per-voice tables
+    return readTables(phase, tables);
+  }
+}
+
+template <typename Vec>
+static bool isGroupActive(const ChunkLayout &layout, int firstVoice) {
+  for (int lane = 0; lane < Vec::width; ++lane)
+    if (layout.voiceActive[firstVoice + lane] > 0.0f)
+      return true;
+
+  return false;
+}
+
+template <typename Vec>
+static typename Vec::Mask getActiveMask(const ChunkLayout &layout,
+                                        int firstVoice) {
+  return Vec::lessThan(Vec::broadcast(0.0f),
+                       Vec::load(layout.voiceActive + firstVoice));
+}
+
+template <typename Vec>
+static void renderEnvelope(const ChunkLayout &layout,
+                           const EnvelopeBlock &env) {
+  const auto zero = Vec::broadcast(0.0f);
+  const auto one = Vec::broadcast(1.0f);
+  const auto never = Vec::broadcast(noSwitchLevel);
+
+  for (int v = 0; v < layout.numVoices; v += Vec::width) {
+    if (!isGroupActive<Vec>(layout, v))
+      continue;
+
+    const auto active = getActiveMask<Vec>(layout, v);
+    auto level = Vec::load(env.level + v);
+
+    auto multiplier = Vec::load(env.segment.multiplier + v);
+    auto offset = Vec::load(env.segment.offset + v);
+    auto floor = Vec::load(env.segment.floor + v);
+    auto ceiling = Vec::load(env.segment.ceiling + v);
+
+    const auto nextMultiplier = Vec::load(env.nextSegment.multiplier + v);
+    const auto nextOffset = Vec::load(env.nextSegment.offset + v);
+    const auto nextFloor = Vec::load(env.nextSegment.floor + v);
+    const auto nextCeiling = Vec::load(env.nextSegment.ceiling + v);
+
+    auto switchLevel = Vec::load(env.switchLevel + v);
+    auto switched = zero;
+
+    for (int n = 0; n < layout.numSamples; ++n) {
+      auto next = Vec::min(Vec::max(level * multiplier + offset, floor),
+                           ceiling);
+      level = Vec::select(active, next, level);
+      Vec::select(active, level, zero)
+          .store(env.output + n * layout.numVoices + v);
+
+      const auto reached = Vec::lessThanOrEqual(switchLevel, level);
+      multiplier = Vec::select(reached, nextMultiplier, multiplier);
+      offset = Vec::select(reached, nextOffset, offset);
+      floor = Vec::select(reached, nextFloor, floor);
+      ceiling = Vec::select(reached, nextCeiling, ceiling);
+      switchLevel = Vec::select(reached, never, switchLevel);
+      switched = Vec::select(reached, one, switched);
+    }
+
+    level.store(env.level + v);
+    switched.store(env.switched + v);
+  }
+}
+
+template <typename Vec, Waveform W>
+static void renderOscillatorGroups(const ChunkLayout &layout,
+                                   const OscillatorBlock &osc) {
+  const auto one = Vec::broadcast(1.0f);
+  const auto zero = Vec::broadcast(0.0f);
+  const auto levelStep = Vec::broadcast(osc.levelStep);
+
+  for (int v = 0; v < layout.numVoices; v += Vec::width) {
+    if (!isGroupActive<Vec>(layout, v))
+      continue;
+
+    const auto active = getActiveMask<Vec>(layout, v);
+    auto phase = Vec::load(osc.phase + v);
+    const auto dt = Vec::load(osc.increment + v);
+    const auto invDt = Vec::load(osc.inverseIncrement + v);
+    const float *const *tables = osc.tables + v;
+    auto level = Vec::broadcast(osc.level);
+
+    for (int n = 0; n < layout.numSamples; ++n) {
+      float *dest = layout.mix + n * layout.numVoices + v;
+
+      auto sample = oscillatorSample<Vec, W>(phase, dt, invDt, tables) * level;
+      sample = Vec::select(active, sample, zero);
+      level = level + levelStep;
+      if (osc.accumulate)
+        sample = Vec::load(dest) + sample;
+      sample.store(dest);
+
+      auto next = phase + dt;
+      next = Vec::select(Vec::lessThanOrEqual(one, next), next - one, next);
+      phase = Vec::select(active, next, phase);
+    }
+
+    phase.store(osc.phase + v);
+  }
+}
+
+template <typename Vec>
+static void renderOscillator(const ChunkLayout &layout,
+                             const OscillatorBlock &osc) {
+  // Pick the waveform kernel once for the whole chunk
+  switch (osc.waveform) {
+  case Waveform::Sine:
+    renderOscillatorGroups<Vec, Waveform::Sine>(layout, osc);
+    break;
+  case Waveform::Saw:
+    renderOscillatorGroups<Vec, Waveform::Saw>(layout, osc);
+    break;
+  case Waveform::Square:
+    renderOscillatorGroups<Vec, Waveform::Square>(layout, osc);
+    break;
+  case Waveform::SawBLEP:
+    renderOscillatorGroups<Vec, Waveform::SawBLEP>(layout, osc);
+    break;
+  case Waveform::SquareBLEP:
+    renderOscillatorGroups<Vec, Waveform::SquareBLEP>(layout, osc);
+    break;
+  case Waveform::SawTable:
+  case Waveform::SquareTable:
+  case Waveform::User:
+    renderOscillatorGroups<Vec, Waveform::User>(layout, osc);
+    break;
+  }
+}
+
+template <typename Vec>
+static void storeLaneSums(const Vec *sums, int numSamples, float *dest) {
+  for (int n = 0; n < numSamples; ++n) {
+    float lanes[maxWidth];
+    sums[n].store(lanes);
+
+    float total = lanes[0];
+    for (int lane = 1; lane < Vec::width; ++lane)
+      total += lanes[lane];
+
+    dest[n] = total;
+  }
+}
+
+template <typename Vec, bool Filtered, bool Stereo>
+static void renderPostMix(const ChunkLayout &layout, const PostBlock &post) {
+  // Per-lane partial sums; lanes are added together once per sample below
+  Vec sums[maxChunkSize];
+  Vec sumsRight[Stereo ? maxChunkSize : 1];
+  for (int n = 0; n < layout.numSamples; ++n) {
+    sums[n] = Vec::broadcast(0.0f);
+    if constexpr (Stereo)
+      sumsRight[n] = Vec::broadcast(0.0f);
+  }
+
+  const auto zero = Vec::broadcast(0.0f);
+  const auto gain = Vec::broadcast(post.gain);
+
+  for (int v = 0; v < layout.numVoices; v += Vec::width) {
+    if (!isGroupActive<Vec>(layout, v))
+      continue;
+
+    const auto active = getActiveMask<Vec>(layout, v);
+    auto peak = zero;
+
+    Vec s1{}, s2{}, g{}, r2{}, h{}, gStep{}, r2Step{}, hStep{};
+    if constexpr (Filtered) {
+      s1 = Vec::load(post.s1 + v);
+      s2 = Vec::load(post.s2 + v);
+      g = Vec::load(post.g + v);
+      r2 = Vec::load(post.r2 + v);
+      h = Vec::load(post.h + v);
+      gStep = Vec::load(post.gStep + v);
+      r2Step = Vec::load(post.r2Step + v);
+      hStep = Vec::load(post.hStep + v);
+    }
+
+    Vec panLeft{}, panRight{};
+    if constexpr (Stereo) {
+      panLeft = Vec::load(post.panLeft + v);
+      panRight = Vec::load(post.panRight + v);
+    }
+
+    for (int n = 0; n < layout.numSamples; ++n) {
+      const auto offset = n * layout.numVoices + v;
+      auto signal = Vec::load(layout.mix + offset);
+
+      if constexpr (Filtered) {
+        auto yHP = h * (signal - s1 * (g + r2) - s2);
+
+        auto yBP = yHP * g + s1;
+        s1 = Vec::select(active, yHP * g + yBP, s1);
+
+        auto yLP = yBP * g + s2;
+        s2 = Vec::select(active, yBP * g + yLP, s2);
+
+        g = g + gStep;
+        r2 = r2 + r2Step;
+        h = h + hStep;
+
+        signal = yLP;
+      }
+
+      // Filter -> ADSR -> master gain, in that order
+      auto output = signal * Vec::load(post.envelope + offset) * gain;
+      output = Vec::select(active, output, zero);
+      peak = Vec::max(peak, Vec::max(output, zero - output));
+
+      // Voices are rendered once in mono and only panned here, at mix time
+      if constexpr (Stereo) {
+        sums[n] = sums[n] + output * panLeft;
+        sumsRight[n] = sumsRight[n] + output * panRight;
+      } else {
+        sums[n] = sums[n] + output;
+      }
+    }
+
+    if constexpr (Filtered) {
+      s1.store(post.s1 + v);
+      s2.store(post.s2 + v);
+    }
+    peak.store(post.peak + v);
+  }
+
+  storeLaneSums(sums, layout.numSamples, post.output);
+  if constexpr (Stereo)
+    storeLaneSums(sumsRight, layout.numSamples, post.outputRight);
+}
+
+template <typename Vec>
+static void renderPost(const ChunkLayout &layout, const PostBlock &post) {
+  const bool stereo = post.panLeft != nullptr;
+
+  if (post.filterEnabled) {
+    if (stereo)
+      renderPostMix<Vec, true, true>(layout, post);
+    else
+      renderPostMix<Vec, true, false>(layout, post);
+  } else {
+    if (stereo)
+      renderPostMix<Vec, false, true>(layout, post);
+    else
+      renderPostMix<Vec, false, false>(layout, post);
+  }
+}
+
+template <typename Vec> static KernelTable makeKernelTable() {
+  KernelTable table{};
+  table.width = Vec::width;
+  table.renderEnvelope = &renderEnvelope<Vec>;
+  table.renderOscillator = &renderOscillator<Vec>;
+  table.renderPost = &renderPost<Vec>;
+  return table;
+}
+
+} // namespace VoiceBankKernels
@@ -0,0 +1,62 @@
+// Compiled with AVX enabled (see CMakeLists.txt). Only reached after a
+// runtime CPU check, so nothing here may be shared with other units: keep
+// JUCE and other headers with inline functions out of this file.
+#include "VoiceBankKernels.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+
+namespace {
+struct AVXVec {
+  static constexpr int width = 8;
+  using Mask = __m256;
+
+  __m256 value;
+
+  static AVXVec broadcast(float v) { return {_mm256_set1_ps(v)}; }
+  static AVXVec load(const float *source) {
+    return {_mm256_loadu_ps(source)};
+  }
+  void store(float *dest) const { _mm256_storeu_ps(dest, value); }
+
+  friend AVXVec operator+(AVXVec a, AVXVec b) {
+    return {_mm256_add_ps(a.value, b.value)};
+  }
+  friend AVXVec operator-(AVXVec a, AVXVec b) {
+    return {_mm256_sub_ps(a.value, b.value)};
+  }
+  friend AVXVec operator*(AVXVec a, AVXVec b) {
+    return {_mm256_mul_ps(a.value, b.value)};
+  }
+
+  static AVXVec min(AVXVec a, AVXVec b) {
+    return {_mm256_min_ps(a.value, b.value)};
+  }
+  static AVXVec max(AVXVec a, AVXVec b) {
+    return {_mm256_max_ps(a.value, b.value)};
+  }
+
+  static Mask lessThan(AVXVec a, AVXVec b) {
+    return _mm256_cmp_ps(a.value, b.value, _CMP_LT_OQ);
+  }
+  static Mask lessThanOrEqual(AVXVec a, AVXVec b) {
+    return _mm256_cmp_ps(a.value, b.value, _CMP_LE_OQ);
+  }
+  static AVXVec select(Mask m, AVXVec a, AVXVec b) {
+    return {_mm256_blendv_ps(b.value, a.value, m)};
+  }
+};
+} // namespace
+#endif
+
+namespace VoiceBankKernels {
+
+KernelTable getAVXKernels() {
+#if defined(__AVX__)
+  return makeKernelTable<AVXVec>();
+#else
+  return KernelTable{};
+#endif
+}
+
+} // namespace VoiceBankKernels
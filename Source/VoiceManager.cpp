@@ -0,0 +1,576 @@
+#include "VoiceManager.h"
+
+namespace {
+// Host MIDI is never legato; generated events say whether they are
+bool isLegatoEvent(const juce::MidiMessageMetadata &) { return false; }
+bool isLegatoEvent(const MidiEventQueue::Event &event) {
+  return event.legato;
+}
+} // namespace
+
+VoiceManager::VoiceManager(VoiceBank &voiceBank) : bank(voiceBank) {
+  // Usable before the host calls prepareToPlay
+  prepare(44100.0);
+}
+
+void VoiceManager::prepare(double sampleRate) {
+  bank.prepare(sampleRate, numVoices);
+
+  voices.fill(Voice());
+  for (auto &channelNotes : noteToVoice)
+    channelNotes.fill(-1);
+  sustainPedalDown.fill(false);
+
+  heldVoices = List();
+  releasingVoices = List();
+  numPendingNotes = 0;
+  numPendingReleases = 0;
+
+  // Lowest index on top, so voices are handed out in order
+  numFree = 0;
+  for (int voice = polyphony - 1; voice >= 0; --voice)
+    freeStack[(size_t)numFree++] = voice;
+}
+
+void VoiceManager::setPolyphony(int newPolyphony) {
+  newPolyphony = juce::jlimit(1, numVoices, newPolyphony);
+  if (newPolyphony == polyphony)
+    return;
+
+  polyphony = newPolyphony;
+
+  numFree = 0;
+  for (int voice = polyphony - 1; voice >= 0; --voice)
+    if (voices[(size_t)voice].list == VoiceList::None)
+      freeStack[(size_t)numFree++] = voice;
+}
+
+void VoiceManager::renderNextBlock(juce::AudioBuffer<float> &outputAudio,
+                                   const juce::MidiBuffer &midiMessages,
+                                   int startSample, int numSamples) {
+  renderEvents(outputAudio, midiMessages, startSample, numSamples);
+}
+
+void VoiceManager::renderNextBlock(juce::AudioBuffer<float> &outputAudio,
+                                   const MidiEventQueue &events,
+                                   int startSample, int numSamples) {
+  renderEvents(outputAudio, events, startSample, numSamples);
+}
+
+template <typename Events>
+void VoiceManager::renderEvents(juce::AudioBuffer<float> &outputAudio,
+                                const Events &events, int startSample,
+                                int numSamples) {
+  const int endSample = startSample + numSamples;
+  int position = startSample;
+
+  auto renderUpTo = [&](int samplePosition) {
+    // Every event at the current position has been seen
+    flushPendingEvents();
+
+    if (samplePosition > position) {
+      bank.render(outputAudio, position, samplePosition - position);
+      collectFinishedVoices();
+      position = samplePosition;
+    }
+  };
+
+  for (const auto &event : events) {
+    if (event.samplePosition < startSample)
+      continue;
+    if (event.samplePosition >= endSample)
+      break;
+    // Long messages (SysEx) play no notes, and copying one into a
+    // MidiMessage would allocate
+    if (event.numBytes > 3)
+      continue;
+
+    if (event.samplePosition > position)
+      renderUpTo(event.samplePosition);
+
+    handleMidiEvent(event.getMessage(), isLegatoEvent(event));
+  }
+
+  renderUpTo(endSample);
+}
+
+void VoiceManager::handleMidiEvent(const juce::MidiMessage &message,
+                                   bool isLegato) {
+  const int channel = message.getChannel();
+
+  // Notes are only held back when they may be played together, or to keep
+  // their place behind notes already held back at this sample
+  const bool groupNotes = chordVoices || isLegato || numPendingNotes > 0 ||
+                          numPendingReleases > 0;
+
+  if (message.isNoteOn()) {
+    const int note = message.getNoteNumber();
+    if (!groupNotes) {
+      noteOn(channel, note);
+      return;
+    }
+
+    if (numPendingNotes > 0 && channel != pendingChannel)
+      flushPendingEvents();
+
+    // A note struck twice at once plays once
+    auto pendingEnd = pendingNotes.begin() + numPendingNotes;
+    if (std::find(pendingNotes.begin(), pendingEnd, note) == pendingEnd) {
+      pendingLegato[(size_t)numPendingNotes] = isLegato;
+      pendingNotes[(size_t)numPendingNotes++] = note;
+      pendingChannel = channel;
+    }
+  } else if (message.isNoteOff()) {
+    const int note = message.getNoteNumber();
+    if (!groupNotes) {
+      noteOff(channel, note, true);
+      return;
+    }
+
+    // A note released at the sample it was struck never starts. The key
+    // release still reaches a voice already playing the note, which the
+    // strike would have taken it from.
+    auto pendingEnd = pendingNotes.begin() + numPendingNotes;
+    auto pending = std::find(pendingNotes.begin(), pendingEnd, note);
+    if (channel == pendingChannel && pending != pendingEnd) {
+      const auto index = (size_t)(pending - pendingNotes.begin());
+      --numPendingNotes;
+      pendingNotes[index] = pendingNotes[(size_t)numPendingNotes];
+      pendingLegato[index] = pendingLegato[(size_t)numPendingNotes];
+    }
+
+    releaseKey(channel, note, isLegato);
+  } else {
+    flushPendingEvents();
+
+    if (message.isAllNotesOff() || message.isAllSoundOff()) {
+      allNotesOff(channel, true);
+    } else if (message.isSustainPedalOn()) {
+      handleSustainPedal(channel, true);
+    } else if (message.isSustainPedalOff()) {
+      handleSustainPedal(channel, false);
+    }
+  }
+}
+
+void VoiceManager::flushPendingEvents() {
+  if (numPendingNotes > 0 && numPendingReleases > 0)
+    retargetReleasedNotes();
+
+  // Releases first, so a chord replacing another frees its voice
+  resolveReleases(true);
+
+  // As chord voices of up to maxVoiceNotes, or one voice per note
+  const int groupSize = chordVoices ? maxVoiceNotes : 1;
+  for (int first = 0; first < numPendingNotes; first += groupSize) {
+    const int count = juce::jmin(groupSize, numPendingNotes - first);
+    startNotes(pendingChannel,
+               {pendingNotes.data() + first, (size_t)count});
+  }
+
+  numPendingNotes = 0;
+}
+
+void VoiceManager::retargetReleasedNotes() {
+  auto &channelNotes = noteToVoice[(size_t)(pendingChannel - 1)];
+
+  // Released notes of voices that only lost legato keys. A pitch sounds on
+  // at most one held voice per channel, so there are at most numNotes.
+  struct ReleasedNote {
+    int note, voice, index;
+  };
+  std::array<ReleasedNote, numNotes> released;
+  int numReleased = 0;
+
+  for (int i = 0; i < numPendingReleases; ++i) {
+    const int voice = pendingReleases[(size_t)i];
+    const auto &state = voices[(size_t)voice];
+    if (!state.releasePending || !state.legatoRelease ||
+        state.list != VoiceList::Held || state.channel != pendingChannel)
+      continue;
+
+    for (int index = 0; index < state.numNotes && numReleased < numNotes;
+         ++index)
+      if ((state.keysDown & (1u << index)) == 0)
+        released[(size_t)numReleased++] = {state.notes[(size_t)index], voice,
+                                           index};
+  }
+
+  // Legato notes to start, as indices into pendingNotes. Notes still held by
+  // a key are left to startNotes().
+  std::array<int, numNotes> struck;
+  int numStruck = 0;
+
+  for (int p = 0; p < numPendingNotes; ++p) {
+    if (!pendingLegato[(size_t)p])
+      continue;
+
+    const int note = pendingNotes[(size_t)p];
+    const int mapped = channelNotes[(size_t)note];
+    if (mapped >= 0 && (voices[(size_t)mapped].keysDown &
+                        (1u << findNote(voices[(size_t)mapped], note))) != 0)
+      continue;
+
+    struck[(size_t)numStruck++] = p;
+  }
+
+  if (numReleased == 0 || numStruck == 0)
+    return;
+
+  std::sort(released.begin(), released.begin() + numReleased,
+            [](const ReleasedNote &a, const ReleasedNote &b) {
+              return a.note < b.note;
+            });
+  std::sort(struck.begin(), struck.begin() + numStruck, [&](int a, int b) {
+    return pendingNotes[(size_t)a] < pendingNotes[(size_t)b];
+  });
+
+  // Pair both lists in pitch order, so moved notes never cross. The longer
+  // list has notes left over; one of those is skipped whenever the note after
+  // it is closer to the other list's next note.
+  std::array<bool, numNotes> retargeted{};
+  int releasedSkips = juce::jmax(0, numReleased - numStruck);
+  int struckSkips = juce::jmax(0, numStruck - numReleased);
+
+  for (int r = 0, s = 0; r < numReleased && s < numStruck;) {
+    const int releasedNote = released[(size_t)r].note;
+    const int struckNote = pendingNotes[(size_t)struck[(size_t)s]];
+
+    if (releasedSkips > 0 &&
+        std::abs(released[(size_t)r + 1].note - struckNote) <
+            std::abs(releasedNote - struckNote)) {
+      ++r;
+      --releasedSkips;
+      continue;
+    }
+
+    if (struckSkips > 0 &&
+        std::abs(pendingNotes[(size_t)struck[(size_t)s + 1]] - releasedNote) <
+            std::abs(struckNote - releasedNote)) {
+      ++s;
+      --struckSkips;
+      continue;
+    }
+
+    retargetNote(released[(size_t)r].voice, released[(size_t)r].index,
+                 struckNote);
+    retargeted[(size_t)struck[(size_t)s]] = true;
+    ++r;
+    ++s;
+  }
+
+  // Only the notes left over start
+  int numLeft = 0;
+  for (int p = 0; p < numPendingNotes; ++p) {
+    if (retargeted[(size_t)p])
+      continue;
+
+    pendingNotes[(size_t)numLeft] = pendingNotes[(size_t)p];
+    pendingLegato[(size_t)numLeft] = pendingLegato[(size_t)p];
+    ++numLeft;
+  }
+  numPendingNotes = numLeft;
+}
+
+void VoiceManager::retargetNote(int voice, int noteIndex,
+                                int midiNoteNumber) {
+  auto &state = voices[(size_t)voice];
+  auto &channelNotes = noteToVoice[(size_t)(state.channel - 1)];
+
+  auto &mapped = channelNotes[(size_t)state.notes[(size_t)noteIndex]];
+  if (mapped == voice)
+    mapped = -1;
+
+  state.notes[(size_t)noteIndex] = static_cast<std::int8_t>(midiNoteNumber);
+  state.keysDown |= 1u << noteIndex;
+  channelNotes[(size_t)midiNoteNumber] = static_cast<std::int16_t>(voice);
+
+  bank.retargetVoiceNote(voice, noteIndex, midiNoteNumber);
+}
+
+void VoiceManager::noteOn(int midiChannel, int midiNoteNumber) {
+  startNotes(midiChannel, {&midiNoteNumber, 1});
+}
+
+void VoiceManager::noteOff(int midiChannel, int midiNoteNumber,
+                           bool allowTailOff) {
+  releaseKey(midiChannel, midiNoteNumber, false);
+  resolveReleases(allowTailOff);
+}
+
+void VoiceManager::startNotes(int midiChannel,
+                              std::span<const int> midiNoteNumbers) {
+  jassert(midiChannel >= 1 && midiChannel <= numChannels);
+  jassert(!midiNoteNumbers.empty() &&
+          midiNoteNumbers.size() <= (size_t)maxVoiceNotes);
+  auto &channelNotes = noteToVoice[(size_t)(midiChannel - 1)];
+
+  // Hitting a note that is still ringing takes it off its old voice first:
+  // the voice is released, or just loses the note if other keys hold it
+  for (auto note : midiNoteNumbers) {
+    const int mapped = channelNotes[(size_t)note];
+    if (mapped < 0)
+      continue;
+
+    const auto &old = voices[(size_t)mapped];
+    const int index = findNote(old, note);
+
+    if ((old.keysDown & ~(1u << index)) != 0)
+      removeNote(mapped, index);
+    else
+      stopVoice(mapped, true);
+  }
+
+  const int voice = allocateVoice();
+  if (voice < 0)
+    return;
+
+  auto &state = voices[(size_t)voice];
+  state.numNotes = (int)midiNoteNumbers.size();
+  state.keysDown = (1u << state.numNotes) - 1u;
+  state.channel = midiChannel;
+  state.sustained = false;
+
+  for (int index = 0; index < state.numNotes; ++index) {
+    const auto note = midiNoteNumbers[(size_t)index];
+    state.notes[(size_t)index] = static_cast<std::int8_t>(note);
+    channelNotes[(size_t)note] = static_cast<std::int16_t>(voice);
+  }
+
+  pushBack(VoiceList::Held, voice);
+  bank.startVoice(voice, midiNoteNumbers);
+}
+
+void VoiceManager::releaseKey(int midiChannel, int midiNoteNumber,
+                              bool isLegato) {
+  jassert(midiChannel >= 1 && midiChannel <= numChannels);
+  const int voice =
+      noteToVoice[(size_t)(midiChannel - 1)][(size_t)midiNoteNumber];
+  if (voice < 0)
+    return;
+
+  auto &state = voices[(size_t)voice];
+  state.keysDown &= ~(1u << findNote(state, midiNoteNumber));
+
+  if (sustainPedalDown[(size_t)(midiChannel - 1)])
+    state.sustained = true;
+  else
+    queueRelease(voice, isLegato);
+}
+
+void VoiceManager::queueRelease(int voice, bool isLegato) {
+  auto &state = voices[(size_t)voice];
+  if (state.releasePending) {
+    state.legatoRelease = state.legatoRelease && isLegato;
+    return;
+  }
+  if (numPendingReleases == numVoices)
+    return;
+
+  state.releasePending = true;
+  state.legatoRelease = isLegato;
+  pendingReleases[(size_t)numPendingReleases++] = voice;
+}
+
+void VoiceManager::resolveReleases(bool allowTailOff) {
+  for (int i = 0; i < numPendingReleases; ++i) {
+    const int voice = pendingReleases[(size_t)i];
+    auto &state = voices[(size_t)voice];
+
+    // Skip voices freed (and reset) since they were queued
+    if (!state.releasePending)
+      continue;
+
+    state.releasePending = false;
+    state.legatoRelease = false;
+    if (state.list != VoiceList::Held)
+      continue;
+
+    if (state.keysDown == 0) {
+      stopVoice(voice, allowTailOff);
+      continue;
+    }
+
+    // Other keys still hold the voice: cut the released notes only. Walking
+    // down, the note moved into a hole has already been checked.
+    for (int index = state.numNotes - 1; index >= 0; --index)
+      if ((state.keysDown & (1u << index)) == 0)
+        removeNote(voice, index);
+  }
+
+  numPendingReleases = 0;
+}
+
+void VoiceManager::removeNote(int voice, int noteIndex) {
+  auto &state = voices[(size_t)voice];
+  auto &mapped = noteToVoice[(size_t)(state.channel - 1)]
+                            [(size_t)state.notes[(size_t)noteIndex]];
+  if (mapped == voice)
+    mapped = -1;
+
+  bank.removeVoiceNote(voice, noteIndex);
+
+  // Mirror the bank: the last note moves into the hole
+  const int last = --state.numNotes;
+  const auto lastKeyDown = (state.keysDown >> last) & 1u;
+  state.keysDown &= ~((1u << noteIndex) | (1u << last));
+
+  if (noteIndex != last) {
+    state.notes[(size_t)noteIndex] = state.notes[(size_t)last];
+    state.keysDown |= lastKeyDown << noteIndex;
+  }
+}
+
+int VoiceManager::findNote(const Voice &voice, int midiNoteNumber) {
+  for (int index = 0; index < voice.numNotes; ++index)
+    if (voice.notes[(size_t)index] == midiNoteNumber)
+      return index;
+
+  jassertfalse;
+  return 0;
+}
+
+void VoiceManager::allNotesOff(int midiChannel, bool allowTailOff) {
+  auto stopAll = [&](List &list) {
+    for (int voice = list.head; voice >= 0;) {
+      const int next = voices[(size_t)voice].next;
+      if (midiChannel <= 0 || voices[(size_t)voice].channel == midiChannel)
+        stopVoice(voice, allowTailOff);
+      voice = next;
+    }
+  };
+
+  stopAll(heldVoices);
+
+  // Voices already releasing only need cutting when tails are not allowed
+  if (!allowTailOff)
+    stopAll(releasingVoices);
+
+  sustainPedalDown.fill(false);
+}
+
+void VoiceManager::handleSustainPedal(int midiChannel, bool isDown) {
+  jassert(midiChannel >= 1 && midiChannel <= numChannels);
+  sustainPedalDown[(size_t)(midiChannel - 1)] = isDown;
+
+  if (isDown)
+    return;
+
+  // Release the notes the pedal was holding
+  for (int voice = heldVoices.head; voice >= 0;
+       voice = voices[(size_t)voice].next) {
+    auto &state = voices[(size_t)voice];
+    if (state.channel == midiChannel && state.sustained) {
+      state.sustained = false;
+      queueRelease(voice, false);
+    }
+  }
+
+  resolveReleases(true);
+}
+
+int VoiceManager::allocateVoice() {
+  if (numFree > 0)
+    return freeStack[(size_t)--numFree];
+
+  // Steal: the oldest releasing voice first, then the oldest held one. Voices
+  // left above a lowered polyphony limit are never reused.
+  for (auto *list : {&releasingVoices, &heldVoices}) {
+    for (int voice = list->head; voice >= 0;
+         voice = voices[(size_t)voice].next) {
+      if (voice < polyphony) {
+        stopVoice(voice, false);
+        return freeStack[(size_t)--numFree];
+      }
+    }
+  }
+
+  return -1;
+}
+
+void VoiceManager::stopVoice(int voice, bool allowTailOff) {
+  auto &state = voices[(size_t)voice];
+  unmapNotes(voice);
+
+  bank.stopVoice(voice, allowTailOff);
+
+  if (!bank.isVoiceActive(voice)) {
+    freeVoice(voice);
+    return;
+  }
+
+  state.keysDown = 0;
+  state.sustained = false;
+
+  unlink(voice);
+  pushBack(VoiceList::Releasing, voice);
+}
+
+void VoiceManager::freeVoice(int voice) {
+  unmapNotes(voice);
+  unlink(voice);
+  voices[(size_t)voice] = Voice();
+
+  if (voice < polyphony)
+    freeStack[(size_t)numFree++] = voice;
+}
+
+void VoiceManager::unmapNotes(int voice) {
+  const auto &state = voices[(size_t)voice];
+
+  for (int index = 0; index < state.numNotes; ++index) {
+    auto &mapped = noteToVoice[(size_t)(state.channel - 1)]
+                              [(size_t)state.notes[(size_t)index]];
+    if (mapped == voice)
+      mapped = -1;
+  }
+}
+
+void VoiceManager::collectFinishedVoices() {
+  for (auto voice : bank.getFinishedVoices())
+    freeVoice(voice);
+}
+
+VoiceManager::List &VoiceManager::getList(VoiceList list) {
+  jassert(list != VoiceList::None);
+  return list == VoiceList::Held ? heldVoices : releasingVoices;
+}
+
+void VoiceManager::pushBack(VoiceList list, int voice) {
+  auto &target = getList(list);
+  auto &state = voices[(size_t)voice];
+  jassert(state.list == VoiceList::None);
+
+  state.list = list;
+  state.previous = target.tail;
+  state.next = -1;
+
+  if (target.tail >= 0)
+    voices[(size_t)target.tail].next = voice;
+  else
+    target.head = voice;
+
+  target.tail = voice;
+}
+
+void VoiceManager::unlink(int voice) {
+  auto &state = voices[(size_t)voice];
+  if (state.list == VoiceList::None)
+    return;
+
+  auto &source = getList(state.list);
+
+  if (state.previous >= 0)
+    voices[(size_t)state.previous].next = state.next;
+  else
+    source.head = state.next;
+
+  if (state.next >= 0)
+    voices[(size_t)state.next].previous = state.previous;
+  else
+    source.tail = state.previous;
+
+  state.list = VoiceList::None;
+  state.previous = -1;
+  state.next = -1;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "MidiEventQueue.h"
+#include "VoiceBank.h"
+#include <JuceHeader.h>
+
+// Turns MIDI into VoiceBank note on/off calls. Replaces juce::Synthesiser,
+// which scans every voice on each event and only sees voices through the
+// SynthesiserVoice interface.
+//
+// - A note -> voice table per MIDI channel answers note-offs and retriggers
+//   without searching.
+// - Free voices (below the polyphony limit) sit on a stack, so allocation is
+//   a pop.
+// - Sounding voices are kept on two intrusive lists in start order: voices in
+//   their release tail and voices still held (by key or sustain pedal).
+//   Stealing takes the oldest releasing voice, which is also the quietest,
+//   and only then the oldest held one. Both are O(1).
+//
+// With chord voices enabled, note-ons on one channel at the same sample share
+// a single voice (see VoiceBank). Its notes release together when all their
+// keys are up; a note released while others are still held is cut from the
+// voice on its own.
+//
+// Note-ons and note-offs marked legato (MidiEventQueue events from a chord
+// change) glide: legato notes released and struck at the same sample are
+// paired up in pitch order, and the sounding note is moved to the new pitch
+// instead of being released and restarted. Only notes left over start
+// or release, so a chord change keeps its voices and envelopes. Unmarked
+// notes, such as arpeggiator steps, always release and restart.
+class VoiceManager {
+public:
+  explicit VoiceManager(VoiceBank &voiceBank);
+
+  // Resets all voice state and prepares the bank for the whole voice pool
+  void prepare(double sampleRate);
+
+  // Voices at or above the limit take no new notes (ones already sounding
+  // finish normally)
+  void setPolyphony(int newPolyphony);
+
+  // Plays note-ons that arrive together on one voice (see above)
+  void setChordVoices(bool shouldGroupNotes) { chordVoices = shouldGroupNotes; }
+
+  // Renders the bank, splitting the block at each MIDI event
+  void renderNextBlock(juce::AudioBuffer<float> &outputAudio,
+                       const juce::MidiBuffer &midiMessages, int startSample,
+                       int numSamples);
+  // The same, from events the processor generated; only these can be legato
+  void renderNextBlock(juce::AudioBuffer<float> &outputAudio,
+                       const MidiEventQueue &events, int startSample,
+                       int numSamples);
+
+  // Immediate single-note calls; grouping only applies to MIDI passed to
+  // renderNextBlock
+  void noteOn(int midiChannel, int midiNoteNumber);
+  void noteOff(int midiChannel, int midiNoteNumber, bool allowTailOff);
+  // midiChannel 0 stops every channel
+  void allNotesOff(int midiChannel, bool allowTailOff);
+  void handleSustainPedal(int midiChannel, bool isDown);
+
+private:
+  static constexpr int numVoices = VoiceBank::maxVoices;
+  static constexpr int maxVoiceNotes = VoiceBank::maxVoiceNotes;
+  static constexpr int numChannels = 16;
+  static constexpr int numNotes = 128;
+
+  enum class VoiceList { None, Held, Releasing };
+
+  struct Voice {
+    // In the bank's layer order
+    std::array<std::int8_t, maxVoiceNotes> notes{};
+    int numNotes{0};
+    std::uint32_t keysDown{0}; // One bit per entry of notes
+    int channel{0};
+    bool sustained{false};      // A key went up while the pedal was down
+    bool releasePending{false}; // Queued for resolveReleases()
+    bool legatoRelease{false};  // Every queued release was legato
+    VoiceList list{VoiceList::None};
+    int previous{-1};
+    int next{-1};
+  };
+
+  struct List {
+    int head{-1}; // Oldest
+    int tail{-1}; // Newest
+  };
+
+  template <typename Events>
+  void renderEvents(juce::AudioBuffer<float> &outputAudio,
+                    const Events &events, int startSample, int numSamples);
+  void handleMidiEvent(const juce::MidiMessage &message, bool isLegato);
+  void flushPendingEvents();
+  void retargetReleasedNotes();
+  void retargetNote(int voice, int noteIndex, int midiNoteNumber);
+
+  void startNotes(int midiChannel, std::span<const int> midiNoteNumbers);
+  void releaseKey(int midiChannel, int midiNoteNumber, bool isLegato);
+  void queueRelease(int voice, bool isLegato);
+  void resolveReleases(bool allowTailOff);
+  void removeNote(int voice, int noteIndex);
+  static int findNote(const Voice &voice, int midiNoteNumber);
+
+  int allocateVoice();
+  void stopVoice(int voice, bool allowTailOff);
+  void freeVoice(int voice);
+  void unmapNotes(int voice);
+  void collectFinishedVoices();
+
+  List &getList(VoiceList list);
+  void pushBack(VoiceList list, int voice);
+  void unlink(int voice);
+
+  VoiceBank &bank;
+  int polyphony{numVoices};
+  bool chordVoices{false};
+
+  std::array<Voice, numVoices> voices;
+  std::array<std::array<std::int16_t, numNotes>, numChannels> noteToVoice;
+  std::array<bool, numChannels> sustainPedalDown{};
+
+  std::array<int, numVoices> freeStack{};
+  int numFree{0};
+
+  List heldVoices;
+  List releasingVoices;
+
+  // Note-ons at the current sample position, started together
+  std::array<int, numNotes> pendingNotes{};
+  std::array<bool, numNotes> pendingLegato{}; // Per pending note
+  int numPendingNotes{0};
+  int pendingChannel{0};
+
+  // Voices with keys released at the current sample position
+  std::array<int, numVoices> pendingReleases{};
+  int numPendingReleases{0};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoiceManager)
+};
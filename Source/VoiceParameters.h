@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+// Everything the voice bank reads from the parameter tree, captured once per
+// block. publish() bumps the version and sets a dirty bit for each group
+// that changed, so the bank can skip the work (ADSR rates, filter tan) for
+// groups that did not move and do nothing at all in steady-state blocks.
+struct VoiceParameters {
+  enum DirtyFlags : std::uint32_t {
+    oscillatorsDirty = 1 << 0,
+    envelopeDirty = 1 << 1,
+    filterDirty = 1 << 2,
+    allDirty = oscillatorsDirty | envelopeDirty | filterDirty
+  };
+
+  struct Oscillator {
+    int waveform{0};   // Index into the oscType choices
+    int rangeIndex{1}; // 0 = 16', 1 = 8', 2 = 4'
+    float level{1.0f};
+    bool isEnabled{true};
+    int userTableIndex{0};
+
+    bool operator==(const Oscillator &) const = default;
+  };
+
+  struct Envelope {
+    float attack{0.1f};
+    float decay{0.1f};
+    float sustain{1.0f};
+    float release{0.4f};
+    bool exponential{false}; // Curved segments instead of juce::ADSR's lines
+
+    bool operator==(const Envelope &) const = default;
+  };
+
+  struct Filter {
+    float cutoff{20000.0f};
+    float resonance{1.0f};
+    float envelopeAmount{0.0f}; // 0 = static cutoff, 1 = envelope opens fully
+    bool isEnabled{true};
+
+    bool operator==(const Filter &) const = default;
+  };
+
+  Oscillator oscA;
+  Oscillator oscB;
+  Envelope envelope;
+  Filter filter;
+
+  // Starts dirty so the first snapshot is always applied in full
+  std::uint32_t version{0};
+  std::uint32_t dirty{allDirty};
+
+  // Takes the values of next; the version only moves when something changed
+  void publish(const VoiceParameters &next) {
+    std::uint32_t changed = 0;
+    if (!(next.oscA == oscA) || !(next.oscB == oscB))
+      changed |= oscillatorsDirty;
+    if (!(next.envelope == envelope))
+      changed |= envelopeDirty;
+    if (!(next.filter == filter))
+      changed |= filterDirty;
+
+    if (changed == 0)
+      return;
+
+    oscA = next.oscA;
+    oscB = next.oscB;
+    envelope = next.envelope;
+    filter = next.filter;
+    dirty = changed;
+    ++version;
+  }
+};
@@ -0,0 +1,64 @@
+#include "WavetableBank.h"
+
+namespace {
+constexpr int tableStride = WavetableBank::tableSize + 1;
+} // namespace
+
+WavetableBank::WavetableBank() {
+  for (int shape = 0; shape < numShapes; ++shape)
+    buildShape(static_cast<Shape>(shape));
+}
+
+int WavetableBank::getLevelForIncrement(float phaseIncrement) {
+  // Level k is alias-free while ((tableSize / 2) >> k) * increment <= 0.5
+  auto maxHarmonicRatio = phaseIncrement * static_cast<float>(tableSize);
+  if (maxHarmonicRatio <= 1.0f)
+    return 0;
+
+  auto level = static_cast<int>(std::ceil(std::log2(maxHarmonicRatio)));
+  return juce::jlimit(0, numLevels - 1, level);
+}
+
+const float *WavetableBank::getTable(Shape shape, int level) const {
+  jassert(level >= 0 && level < numLevels);
+  return tables[(size_t)shape].data() + (size_t)(level * tableStride);
+}
+
+void WavetableBank::buildShape(Shape shape) {
+  auto &table = tables[(size_t)shape];
+  table.assign((size_t)(numLevels * tableStride), 0.0f);
+
+  // One cycle of sin(2 * pi * n / tableSize); harmonic h at sample n is
+  // sineTable[(h * n) % tableSize], so building needs no per-sample trig
+  std::vector<double> sineTable((size_t)tableSize);
+  for (int n = 0; n < tableSize; ++n)
+    sineTable[(size_t)n] =
+        std::sin(juce::MathConstants<double>::twoPi * n / tableSize);
+
+  std::vector<double> accumulator((size_t)tableSize);
+
+  for (int level = 0; level < numLevels; ++level) {
+    const int numHarmonics = (tableSize / 2) >> level;
+    std::fill(accumulator.begin(), accumulator.end(), 0.0);
+
+    // Fourier series of the naive shapes (2t - 1 saw, low-then-high square)
+    // so the tables line up in phase and level with the other kernels
+    for (int h = 1; h <= numHarmonics; ++h) {
+      if (shape == Shape::Square && (h % 2) == 0)
+        continue;
+
+      const double amplitude =
+          (shape == Shape::Saw ? -2.0 : -4.0) /
+          (juce::MathConstants<double>::pi * h);
+
+      for (int n = 0; n < tableSize; ++n)
+        accumulator[(size_t)n] +=
+            amplitude * sineTable[(size_t)((h * n) % tableSize)];
+    }
+
+    auto *dest = table.data() + (size_t)(level * tableStride);
+    for (int n = 0; n < tableSize; ++n)
+      dest[n] = static_cast<float>(accumulator[(size_t)n]);
+    dest[tableSize] = dest[0];
+  }
+}
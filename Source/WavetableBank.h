@@ -0,0 +1,35 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Immutable, band-limited wavetables for the built-in shapes, one mip level
+// per octave. A single bank is shared by every voice of every plugin instance
+// in the process through juce::SharedResourcePointer, so the tables are built
+// once (on the message thread, when the first instance is created) and only
+// ever read afterwards.
+class WavetableBank {
+public:
+  enum class Shape { Saw = 0, Square };
+  static constexpr int numShapes = 2;
+
+  static constexpr int tableSize = 2048;
+  // Level k holds (tableSize / 2) >> k harmonics, down to a pure sine
+  static constexpr int numLevels = 11;
+
+  WavetableBank();
+
+  // Returns the mip level whose highest harmonic stays below Nyquist for the
+  // given phase increment (cycles per sample)
+  static int getLevelForIncrement(float phaseIncrement);
+
+  // Returns tableSize + 1 samples; the last one repeats the first so readers
+  // can interpolate without wrapping
+  const float *getTable(Shape shape, int level) const;
+
+private:
+  void buildShape(Shape shape);
+
+  std::array<std::vector<float>, numShapes> tables;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableBank)
+};
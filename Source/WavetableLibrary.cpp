@@ -0,0 +1,252 @@
+#include "WavetableLibrary.h"
+
+namespace {
+constexpr juce::int32 libraryMagic = 0x5457534d; // "MSWT" in file order
+constexpr juce::int32 libraryVersion = 1;
+constexpr size_t headerSize = 4 * sizeof(juce::int32);
+constexpr int tableStride = WavetableLibrary::tableSize + 1;
+
+// Longest WAV the importer will read (in samples)
+constexpr juce::int64 maxImportLength = 1 << 22;
+} // namespace
+
+WavetableLibrary::WavetableLibrary() : juce::Thread("MySynth Wavetables") {
+  startThread();
+}
+
+WavetableLibrary::~WavetableLibrary() { stopThread(2000); }
+
+juce::File WavetableLibrary::getDefaultLibraryFile() {
+  return juce::File::getSpecialLocation(
+             juce::File::userApplicationDataDirectory)
+      .getChildFile("MySynth")
+      .getChildFile("Wavetables.mswt");
+}
+
+juce::File WavetableLibrary::getDefaultImportFolder() {
+  return juce::File::getSpecialLocation(
+             juce::File::userApplicationDataDirectory)
+      .getChildFile("MySynth")
+      .getChildFile("Wavetables");
+}
+
+bool WavetableLibrary::importWavFiles(const juce::Array<juce::File> &sources,
+                                      const juce::File &destination) {
+  juce::AudioFormatManager formatManager;
+  formatManager.registerBasicFormats();
+
+  std::vector<float> tables;
+
+  for (const auto &source : sources) {
+    std::unique_ptr<juce::AudioFormatReader> reader(
+        formatManager.createReaderFor(source));
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+      continue;
+
+    auto length =
+        static_cast<int>(juce::jmin(reader->lengthInSamples, maxImportLength));
+    juce::AudioBuffer<float> buffer((int)reader->numChannels, length);
+    reader->read(&buffer, 0, length, 0, true, false);
+    const auto *samples = buffer.getReadPointer(0);
+
+    if (length % tableSize == 0) {
+      // Frame-based wavetable: one table per tableSize block
+      tables.insert(tables.end(), samples, samples + length);
+    } else {
+      // Single cycle of arbitrary length: resample it to tableSize
+      for (int n = 0; n < tableSize; ++n) {
+        auto position = static_cast<double>(n) * length / tableSize;
+        auto index = static_cast<int>(position);
+        auto frac = static_cast<float>(position - index);
+        auto next = (index + 1) % length;
+        tables.push_back(samples[index] +
+                         frac * (samples[next] - samples[index]));
+      }
+    }
+  }
+
+  if (tables.empty())
+    return false;
+
+  destination.getParentDirectory().createDirectory();
+
+  // Write next to the destination and swap in, so a mapped library is never
+  // seen half-written
+  juce::TemporaryFile tempFile(destination);
+  {
+    juce::FileOutputStream out(tempFile.getFile());
+    if (!out.openedOk())
+      return false;
+
+    out.writeInt(libraryMagic);
+    out.writeInt(libraryVersion);
+    out.writeInt(tableSize);
+    out.writeInt(static_cast<int>(tables.size() / (size_t)tableSize));
+
+#if JUCE_BIG_ENDIAN
+    for (auto sample : tables)
+      out.writeFloat(sample);
+#else
+    out.write(tables.data(), tables.size() * sizeof(float));
+#endif
+
+    out.flush();
+    if (out.getStatus().failed())
+      return false;
+  }
+
+  return tempFile.overwriteTargetFileWithTemporary();
+}
+
+int WavetableLibrary::getNumTables() const {
+  return numTables.load(std::memory_order_acquire);
+}
+
+const float *WavetableLibrary::getTable(int tableIndex, int level) {
+  jassert(level >= 0 && level < numLevels);
+
+  if (!juce::isPositiveAndBelow(tableIndex, getNumTables()))
+    return nullptr;
+
+  auto &slot = slots[(size_t)tableIndex];
+  if (auto *levels = slot.levels.load(std::memory_order_acquire))
+    return levels + (size_t)(level * tableStride);
+
+  // Not built yet: flag it for the worker, which polls for requests
+  if (!slot.requested.exchange(true))
+    buildRequested.store(true);
+
+  return nullptr;
+}
+
+void WavetableLibrary::run() {
+  auto libraryFile = getDefaultLibraryFile();
+
+  // One-time conversion of the import folder into the compact format
+  if (!libraryFile.existsAsFile()) {
+    auto importFolder = getDefaultImportFolder();
+    if (importFolder.isDirectory()) {
+      auto wavFiles = importFolder.findChildFiles(juce::File::findFiles,
+                                                  false, "*.wav");
+      wavFiles.sort();
+      if (!wavFiles.isEmpty())
+        importWavFiles(wavFiles, libraryFile);
+    }
+  }
+
+  openLibrary(libraryFile);
+
+  while (!threadShouldExit()) {
+    if (buildRequested.exchange(false)) {
+      const int count = getNumTables();
+      for (int i = 0; i < count && !threadShouldExit(); ++i) {
+        auto &slot = slots[(size_t)i];
+        if (slot.requested.load() && slot.levels.load() == nullptr)
+          buildMipLevels(i);
+      }
+    }
+
+    wait(20);
+  }
+}
+
+void WavetableLibrary::openLibrary(const juce::File &file) {
+  if (!file.existsAsFile())
+    return;
+
+  auto mapped = std::make_unique<juce::MemoryMappedFile>(
+      file, juce::MemoryMappedFile::readOnly);
+  const auto *data = static_cast<const char *>(mapped->getData());
+
+  if (data == nullptr || mapped->getSize() < headerSize)
+    return;
+
+  auto readHeaderField = [data](int index) {
+    return static_cast<juce::int32>(
+        juce::ByteOrder::littleEndianInt(data + index * sizeof(juce::int32)));
+  };
+
+  if (readHeaderField(0) != libraryMagic ||
+      readHeaderField(1) != libraryVersion ||
+      readHeaderField(2) != tableSize)
+    return;
+
+  const auto count = readHeaderField(3);
+  if (count <= 0 || headerSize + (size_t)count * tableSize * sizeof(float) >
+                        mapped->getSize())
+    return;
+
+  slots = std::make_unique<TableSlot[]>((size_t)count);
+  rawTables = reinterpret_cast<const float *>(data + headerSize);
+  mappedFile = std::move(mapped);
+
+  // Publish last: readers only touch slots below numTables
+  numTables.store(count, std::memory_order_release);
+}
+
+void WavetableLibrary::buildMipLevels(int tableIndex) {
+  constexpr int numHarmonics = tableSize / 2;
+
+  // First touch of this table's pages in the mapped file
+  const float *source = rawTables + (size_t)tableIndex * tableSize;
+
+  std::vector<double> cosTable((size_t)tableSize), sinTable((size_t)tableSize);
+  for (int n = 0; n < tableSize; ++n) {
+    auto angle = juce::MathConstants<double>::twoPi * n / tableSize;
+    cosTable[(size_t)n] = std::cos(angle);
+    sinTable[(size_t)n] = std::sin(angle);
+  }
+
+  // Fourier coefficients of the cycle, DC dropped
+  std::vector<double> cosCoeffs((size_t)numHarmonics + 1, 0.0);
+  std::vector<double> sinCoeffs((size_t)numHarmonics + 1, 0.0);
+
+  for (int h = 1; h <= numHarmonics; ++h) {
+    double c = 0.0, s = 0.0;
+    for (int n = 0; n < tableSize; ++n) {
+      auto index = (size_t)((h * n) % tableSize);
+      c += source[n] * cosTable[index];
+      s += source[n] * sinTable[index];
+    }
+
+    // The Nyquist bin has no conjugate partner
+    auto scale = (h == numHarmonics ? 1.0 : 2.0) / tableSize;
+    cosCoeffs[(size_t)h] = c * scale;
+    sinCoeffs[(size_t)h] = s * scale;
+  }
+
+  auto storage = std::make_unique<float[]>((size_t)(numLevels * tableStride));
+  std::vector<double> accumulator((size_t)tableSize);
+  double normalisation = 1.0;
+
+  // Same harmonic budget per level as the built-in bank
+  for (int level = 0; level < numLevels; ++level) {
+    std::fill(accumulator.begin(), accumulator.end(), 0.0);
+
+    for (int h = 1; h <= (numHarmonics >> level); ++h)
+      for (int n = 0; n < tableSize; ++n) {
+        auto index = (size_t)((h * n) % tableSize);
+        accumulator[(size_t)n] += cosCoeffs[(size_t)h] * cosTable[index] +
+                                  sinCoeffs[(size_t)h] * sinTable[index];
+      }
+
+    // Scale every level by the full-band peak so levels match in loudness
+    if (level == 0) {
+      double peak = 0.0;
+      for (auto sample : accumulator)
+        peak = juce::jmax(peak, std::abs(sample));
+
+      if (peak > 1.0e-6)
+        normalisation = 1.0 / peak;
+    }
+
+    auto *dest = storage.get() + (size_t)(level * tableStride);
+    for (int n = 0; n < tableSize; ++n)
+      dest[n] = static_cast<float>(accumulator[(size_t)n] * normalisation);
+    dest[tableSize] = dest[0];
+  }
+
+  auto &slot = slots[(size_t)tableIndex];
+  slot.storage = std::move(storage);
+  slot.levels.store(slot.storage.get(), std::memory_order_release);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "WavetableBank.h"
+#include <JuceHeader.h>
+
+// User wavetables stored in a compact, memory-mapped file:
+//
+//   int32 magic ('MSWT'), int32 version, int32 tableSize, int32 numTables
+//   numTables * tableSize float32 single-cycle tables (little endian)
+//
+// The file is mapped read-only, so opening it only touches the header and a
+// table's pages are faulted in when its mip levels are first built. Mip levels
+// are built lazily on a background thread the first time a table is asked
+// for, then published to the audio thread and kept until shutdown. One library
+// is shared by every plugin instance through juce::SharedResourcePointer.
+class WavetableLibrary : private juce::Thread {
+public:
+  static constexpr int tableSize = WavetableBank::tableSize;
+  static constexpr int numLevels = WavetableBank::numLevels;
+
+  WavetableLibrary();
+  ~WavetableLibrary() override;
+
+  // <user app data>/MySynth/Wavetables.mswt
+  static juce::File getDefaultLibraryFile();
+  // <user app data>/MySynth/Wavetables; WAVs found here are converted into
+  // the library file the first time it is missing
+  static juce::File getDefaultImportFolder();
+
+  // Converts WAV files to the library format. Files whose length is a
+  // multiple of tableSize are split into one table per frame, anything else
+  // is treated as a single cycle and resampled to tableSize.
+  static bool importWavFiles(const juce::Array<juce::File> &sources,
+                             const juce::File &destination);
+
+  // Returns 0 until the library has been opened
+  int getNumTables() const;
+
+  // Audio-thread safe. Returns tableSize + 1 samples for the requested mip
+  // level, or nullptr while the table is missing or still being built (in
+  // which case the build is queued).
+  const float *getTable(int tableIndex, int level);
+
+private:
+  struct TableSlot {
+    std::atomic<const float *> levels{nullptr};
+    std::atomic<bool> requested{false};
+    std::unique_ptr<float[]> storage;
+  };
+
+  void run() override;
+  void openLibrary(const juce::File &file);
+  void buildMipLevels(int tableIndex);
+
+  std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+  const float *rawTables{nullptr}; // Points into mappedFile
+  std::unique_ptr<TableSlot[]> slots;
+  std::atomic<int> numTables{0};
+  std::atomic<bool> buildRequested{false};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableLibrary)
+};
@@ -0,0 +1,139 @@
+#include "ArpScheduler.h"
+#include "Tests.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <random>
+#include <utility>
+
+namespace {
+
+constexpr double hoursPerRun = 3.0;
+constexpr int maxBlockSize = 2048;
+constexpr int numRates = 6; // 1/2 to 1/64
+
+enum class Transport { FreeRunning, Host, Toggling };
+
+struct RunResult {
+  std::int64_t numSteps{0};
+  std::int64_t numErrors{0};
+  std::int64_t maxError{0};
+};
+
+// Renders hoursPerRun of timeline in random block sizes and compares every
+// step the scheduler fires with its ideal sample: the first one at or after
+// the step's start, worked out in long double from the quarter-note position.
+// A missed or doubled step shifts every later pairing, so it shows up as
+// errors too.
+RunResult runTimeline(Transport transport, bool tempoChanges,
+                      double sampleRate, int rateIndex, unsigned seed) {
+  std::mt19937 random(seed);
+  std::uniform_int_distribution<int> blockSizes(1, maxBlockSize);
+  std::uniform_real_distribution<double> tempos(60.0, 200.0);
+
+  const std::int64_t stepTicks =
+      (2 * ArpScheduler::ticksPerQuarter) >> rateIndex;
+  const long double stepQuarters = 2.0L / (long double)(1 << rateIndex);
+
+  ArpScheduler scheduler;
+  double bpm = 120.0;
+  bool hostPlaying = transport != Transport::FreeRunning;
+
+  long double quarters = 0.0L; // Position at the block start
+  std::int64_t sample = 0;
+  // Free-running from the start, the first step comes one step in
+  std::int64_t nextIdealStep = transport == Transport::FreeRunning ? 1 : 0;
+  std::deque<std::int64_t> fired;
+  std::deque<std::int64_t> ideal;
+
+  RunResult result;
+  auto compare = [&] {
+    for (; !fired.empty() && !ideal.empty();
+         fired.pop_front(), ideal.pop_front()) {
+      const auto error = std::abs(fired.front() - ideal.front());
+      result.maxError = std::max(result.maxError, error);
+      result.numErrors += error > 1 ? 1 : 0;
+      ++result.numSteps;
+    }
+  };
+
+  const auto numSamples = (std::int64_t)(hoursPerRun * 3600.0 * sampleRate);
+  while (sample < numSamples) {
+    if (tempoChanges && random() % 2000 == 0)
+      bpm = tempos(random);
+    if (transport == Transport::Toggling && random() % 500 == 0)
+      hostPlaying = !hostPlaying;
+
+    const int blockSize = blockSizes(random);
+    const long double samplesPerQuarter = 60.0L * sampleRate / bpm;
+
+    std::optional<double> hostPpq;
+    if (hostPlaying)
+      hostPpq = (double)quarters;
+
+    scheduler.process(hostPpq, bpm, sampleRate, stepTicks, blockSize,
+                      [&](int offset) { fired.push_back(sample + offset); });
+
+    const long double blockEnd = quarters + blockSize / samplesPerQuarter;
+    for (;; ++nextIdealStep) {
+      const long double start = (long double)nextIdealStep * stepQuarters;
+      if (start >= blockEnd)
+        break;
+      ideal.push_back(sample +
+                      (std::int64_t)std::ceil((start - quarters) *
+                                                  samplesPerQuarter -
+                                              1.0e-6L));
+    }
+
+    quarters = blockEnd;
+    sample += blockSize;
+    compare();
+  }
+
+  // A step within a sample of the end may land on either side of it
+  for (auto last : fired)
+    result.numErrors += last < sample - 1 ? 1 : 0;
+  for (auto last : ideal)
+    result.numErrors += last < sample - 1 ? 1 : 0;
+
+  return result;
+}
+
+} // namespace
+
+bool Tests::runArpSchedulerTests() {
+  const std::pair<const char *, Transport> transports[] = {
+      {"free-running", Transport::FreeRunning},
+      {"host PPQ", Transport::Host},
+      {"host PPQ, transport toggling", Transport::Toggling}};
+
+  bool passed = true;
+  unsigned seed = 1;
+
+  for (const auto &[name, transport] : transports) {
+    for (bool tempoChanges : {false, true}) {
+      RunResult total;
+      for (double sampleRate : {44100.0, 48000.0, 96000.0}) {
+        for (int rate = 0; rate < numRates; ++rate) {
+          const auto result =
+              runTimeline(transport, tempoChanges, sampleRate, rate, seed++);
+          total.numSteps += result.numSteps;
+          total.numErrors += result.numErrors;
+          total.maxError = std::max(total.maxError, result.maxError);
+        }
+      }
+
+      std::printf("  %s%s: %lld steps, %lld off by more than one sample, "
+                  "max error %lld\n",
+                  name, tempoChanges ? ", tempo changes" : "",
+                  (long long)total.numSteps, (long long)total.numErrors,
+                  (long long)total.maxError);
+      passed = passed && total.numErrors == 0;
+    }
+  }
+
+  return passed;
+}
@@ -0,0 +1,129 @@
+#include "ChordTables.h"
+#include "Tests.h"
+
+#include <array>
+#include <cstdint>
+
+namespace {
+
+using namespace ChordTables;
+
+// The lowest and highest notes the range parameters allow
+constexpr int minRangeNote = 24;
+constexpr int maxRangeNote = 127;
+
+// The generator playChord used before ChordCache: intervals picked from the
+// pressed modifier keys, then every note of the root's and each interval's
+// pitch class in [lowLimit, highLimit], skipping repeats. Kept as it was,
+// apart from a fixed array in place of the std::vector it filled.
+struct LegacyChord {
+  std::array<int, NoteSet::numNotes> notes{};
+  int size{0};
+};
+
+LegacyChord generateLegacyChord(int modifierMask, int triggerNote,
+                                int lowLimit, int highLimit) {
+  std::array<int, maxIntervals> intervals{};
+  int numIntervals = 0;
+
+  if (modifierMask & dimKey) {
+    intervals[(size_t)numIntervals++] = 3;
+    intervals[(size_t)numIntervals++] = 6;
+  } else if (modifierMask & minKey) {
+    intervals[(size_t)numIntervals++] = 3;
+    intervals[(size_t)numIntervals++] = 7;
+  } else if (modifierMask & majKey) {
+    intervals[(size_t)numIntervals++] = 4;
+    intervals[(size_t)numIntervals++] = 7;
+  } else if (modifierMask & sus2Key) {
+    intervals[(size_t)numIntervals++] = 2;
+    intervals[(size_t)numIntervals++] = 7;
+  }
+
+  if (modifierMask & sixKey) {
+    intervals[(size_t)numIntervals++] = 9;
+  } else if (modifierMask & min7Key) {
+    intervals[(size_t)numIntervals++] = 10;
+  } else if (modifierMask & maj7Key) {
+    intervals[(size_t)numIntervals++] = 11;
+  } else if (modifierMask & nineKey) {
+    intervals[(size_t)numIntervals++] = 10;
+    intervals[(size_t)numIntervals++] = 14;
+  }
+
+  LegacyChord chord;
+  auto addNotesInRange = [&](int baseNote) {
+    int pitchClass = baseNote % 12;
+
+    int candidate = lowLimit;
+    int candidatePitchClass = candidate % 12;
+
+    int diff = pitchClass - candidatePitchClass;
+    if (diff < 0)
+      diff += 12;
+
+    candidate += diff;
+
+    while (candidate <= highLimit) {
+      if (candidate <= 127) {
+        bool exists = false;
+
+        for (int i = 0; i < chord.size; ++i) {
+          if (chord.notes[(size_t)i] == candidate) {
+            exists = true;
+            break;
+          }
+        }
+        if (!exists)
+          chord.notes[(size_t)chord.size++] = candidate;
+      }
+      candidate += 12;
+    }
+  };
+
+  addNotesInRange(triggerNote);
+  for (int i = 0; i < numIntervals; ++i)
+    addNotesInRange(triggerNote + intervals[(size_t)i]);
+
+  return chord;
+}
+
+// Same notes, each once; the cache plays a chord in ascending order
+bool matches(const NoteSet &notes, const LegacyChord &legacy) {
+  NoteSet legacyNotes;
+  for (int i = 0; i < legacy.size; ++i)
+    legacyNotes.add(legacy.notes[(size_t)i]);
+
+  return legacyNotes.size() == legacy.size && legacyNotes == notes;
+}
+
+} // namespace
+
+bool Tests::runChordTableTests() {
+  ChordCache cache;
+  std::int64_t numCases = 0;
+  std::int64_t numMismatches = 0;
+
+  for (int low = minRangeNote; low <= maxRangeNote; ++low) {
+    for (int high = minRangeNote; high <= maxRangeNote; ++high) {
+      cache.setRange(low, high);
+
+      for (int mask = 0; mask < numModifierMasks; ++mask) {
+        for (int root = 0; root < NoteSet::numNotes; ++root) {
+          ++numCases;
+          const auto legacy = generateLegacyChord(mask, root, low, high);
+          if (matches(cache.getNotes(mask, root), legacy))
+            continue;
+
+          if (++numMismatches <= 10)
+            std::printf("  mismatch: range %d-%d, mask 0x%02x, root %d\n", low,
+                        high, mask, root);
+        }
+      }
+    }
+  }
+
+  std::printf("  %lld cases, %lld mismatches\n", (long long)numCases,
+              (long long)numMismatches);
+  return numMismatches == 0;
+}
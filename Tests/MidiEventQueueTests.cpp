@@ -0,0 +1,114 @@
+#include "MidiEventQueue.h"
+#include "Tests.h"
+
+#include <JuceHeader.h>
+
+namespace {
+
+constexpr int capacity = MidiEventQueue::capacity;
+constexpr int releaseReserve = MidiEventQueue::releaseReserve;
+constexpr int numOtherSlots = capacity - releaseReserve;
+
+bool isNoteOn(const MidiEventQueue::Event &event) {
+  return (event.bytes[0] & 0xf0) == 0x90 && event.bytes[2] != 0;
+}
+
+// The reserve's worth of events that end notes, every kind endsNotes()
+// accepts, on channels 1-16 in turn
+void addReleases(MidiEventQueue &queue, int samplePosition) {
+  for (int i = 0; i < releaseReserve; ++i) {
+    const int channel = 1 + i % 16;
+    switch (i % 5) {
+    case 0:
+      queue.addNoteOff(channel, i % 128, 0.0f, samplePosition);
+      break;
+    case 1:
+      queue.add(juce::MidiMessage::noteOn(channel, i % 128, (juce::uint8)0),
+                samplePosition);
+      break;
+    case 2:
+      queue.add(juce::MidiMessage::controllerEvent(channel, 64, 0),
+                samplePosition);
+      break;
+    case 3:
+      queue.add(juce::MidiMessage::allSoundOff(channel), samplePosition);
+      break;
+    default:
+      queue.add(juce::MidiMessage::allNotesOff(channel), samplePosition);
+      break;
+    }
+  }
+}
+
+// Note-ons fill the queue up to the reserve and no further; the reserve then
+// takes one release per slot, and only a release past it is dropped
+bool checkAdd() {
+  MidiEventQueue queue;
+  for (int i = 0; i < capacity; ++i)
+    queue.addNoteOn(1, i % 128, 1.0f, i);
+
+  const int numNoteOns = queue.size();
+
+  addReleases(queue, capacity);
+  const int numAfterReleases = queue.size();
+  const bool reserveDropped = queue.getDroppedReleaseChannels() != 0;
+
+  int numReleases = 0;
+  for (const auto &event : queue)
+    numReleases += isNoteOn(event) ? 0 : 1;
+
+  queue.addNoteOn(2, 60, 1.0f, capacity);
+  queue.addNoteOff(3, 60, 0.0f, capacity);
+  const bool overflowRecorded = queue.size() == capacity &&
+                                queue.getDroppedReleaseChannels() == (1 << 2);
+
+  std::printf("  add: %d of %d note-ons kept, %d of %d releases kept, "
+              "overflow %s\n",
+              numNoteOns, capacity, numReleases, releaseReserve,
+              overflowRecorded ? "recorded" : "NOT recorded");
+
+  return numNoteOns == numOtherSlots && numAfterReleases == capacity &&
+         numReleases == releaseReserve && !reserveDropped && overflowRecorded;
+}
+
+// The processor's last stage: host input merged with a generated queue
+// that already took every slot but the reserve. The host's note-ons come too
+// late to fit; its note-offs must not be refused with them.
+bool checkMerge() {
+  MidiEventQueue generated;
+  for (int i = 0; i < numOtherSlots; ++i)
+    generated.addNoteOn(1, i % 128, 1.0f, i);
+
+  juce::MidiBuffer input;
+  for (int i = 0; i < releaseReserve; ++i) {
+    input.addEvent(juce::MidiMessage::noteOn(2, i % 128, 1.0f),
+                   numOtherSlots + i);
+    input.addEvent(juce::MidiMessage::noteOff(2, i % 128), numOtherSlots + i);
+  }
+
+  MidiEventQueue merged;
+  merged.merge(input, generated);
+
+  int numReleases = 0;
+  bool inOrder = true;
+  int lastPosition = 0;
+  for (const auto &event : merged) {
+    numReleases += isNoteOn(event) ? 0 : 1;
+    inOrder = inOrder && event.samplePosition >= lastPosition;
+    lastPosition = event.samplePosition;
+  }
+
+  std::printf("  merge: %d events, %d of %d releases kept%s\n", merged.size(),
+              numReleases, releaseReserve, inOrder ? "" : ", OUT OF ORDER");
+
+  return merged.size() == capacity && numReleases == releaseReserve &&
+         inOrder && merged.getDroppedReleaseChannels() == 0;
+}
+
+} // namespace
+
+bool Tests::runMidiEventQueueTests() {
+  const bool addPassed = checkAdd();
+  const bool mergePassed = checkMerge();
+  return addPassed && mergePassed;
+}
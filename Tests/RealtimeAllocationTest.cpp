@@ -0,0 +1,156 @@
+#include "PluginProcessor.h"
+#include <JuceHeader.h>
+
+#include <cstdio>
+
+// Drives processBlock through every MIDI-layer mode with
+// MYSYNTH_DETECT_RT_ALLOCATIONS on: the detector aborts the process at the
+// first heap allocation inside a block, so reaching the end is a pass.
+//
+// What counts as an allocation depends on the platform. With glibc the
+// malloc family is hooked (malloc, calloc, realloc, free, aligned_alloc,
+// posix_memalign, memalign, valloc, pvalloc); memory mapped directly with
+// mmap is not seen. Elsewhere only operator new and delete are replaced, so
+// a malloc from C code or a system library passes unnoticed: run this test
+// on Linux for the full check.
+namespace {
+
+constexpr double sampleRate = 48000.0;
+constexpr int maxBlockSize = 512;
+constexpr int numBlocks = 4000;
+
+// A transport at a fixed tempo, playing or stopped
+class TestPlayHead : public juce::AudioPlayHead {
+public:
+  juce::Optional<PositionInfo> getPosition() const override {
+    PositionInfo info;
+    info.setBpm(bpm);
+    info.setIsPlaying(isPlaying);
+    if (isPlaying)
+      info.setPpqPosition(ppq);
+    return info;
+  }
+
+  double bpm{128.0};
+  bool isPlaying{false};
+  double ppq{0.0};
+};
+
+struct Scenario {
+  const char *name;
+  bool chordMode;
+  bool retrigger;
+  bool chordVoice;
+  bool glide;
+  bool arp;
+  bool transportPlaying;
+  int polyphony;
+};
+
+constexpr Scenario scenarios[] = {
+    {"pass-through", false, false, false, false, false, false, 16},
+    {"pass-through, voice stealing", false, false, false, false, false, false,
+     8},
+    {"chord mode", true, false, false, false, false, false, 16},
+    {"chord mode, legato", true, false, false, true, false, false, 16},
+    {"chord mode, retrigger", true, true, false, false, false, false, 16},
+    {"chord mode, chord voices", true, false, true, false, false, false, 16},
+    {"chord mode + arp, free-running", true, false, false, false, true, false,
+     16},
+    {"chord mode + arp, host transport", true, false, false, false, true, true,
+     16},
+    {"arp without chord mode", false, false, false, false, true, true, 16},
+};
+
+void setParameter(MySynthAudioProcessor &processor, const char *id,
+                  float value) {
+  auto *parameter = processor.apvts.getParameter(id);
+  parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+// Random notes over the whole keyboard (modifier and trigger keys
+// included), sustain pedal, pitch bend and now and then a SysEx message
+void addRandomEvents(juce::Random &random, juce::MidiBuffer &midi,
+                     int numSamples) {
+  const int numEvents = random.nextInt(6);
+  for (int i = 0; i < numEvents; ++i) {
+    const int position = random.nextInt(numSamples);
+    const int kind = random.nextInt(20);
+
+    if (kind < 8) {
+      midi.addEvent(juce::MidiMessage::noteOn(1, 24 + random.nextInt(104),
+                                              random.nextFloat()),
+                    position);
+    } else if (kind < 16) {
+      midi.addEvent(juce::MidiMessage::noteOff(1, 24 + random.nextInt(104)),
+                    position);
+    } else if (kind < 18) {
+      midi.addEvent(juce::MidiMessage::controllerEvent(
+                        1, 64, random.nextBool() ? 127 : 0),
+                    position);
+    } else if (kind < 19) {
+      midi.addEvent(juce::MidiMessage::pitchWheel(1, random.nextInt(16384)),
+                    position);
+    } else {
+      const juce::uint8 data[] = {0x7d, 0x01, 0x02, 0x03};
+      midi.addEvent(juce::MidiMessage::createSysExMessage(data, 4), position);
+    }
+  }
+}
+
+void runScenario(MySynthAudioProcessor &processor, TestPlayHead &playHead,
+                 const Scenario &scenario) {
+  std::printf("  %s\n", scenario.name);
+
+  setParameter(processor, "chordMode", scenario.chordMode ? 1.0f : 0.0f);
+  setParameter(processor, "retriggerMode", scenario.retrigger ? 1.0f : 0.0f);
+  setParameter(processor, "chordVoice", scenario.chordVoice ? 1.0f : 0.0f);
+  setParameter(processor, "chordGlide", scenario.glide ? 1.0f : 0.0f);
+  setParameter(processor, "arpEnabled", scenario.arp ? 1.0f : 0.0f);
+  setParameter(processor, "polyphony", (float)scenario.polyphony);
+  playHead.isPlaying = scenario.transportPlaying;
+
+  juce::Random random(1234);
+  juce::AudioBuffer<float> buffer(2, maxBlockSize);
+  juce::MidiBuffer midi;
+  midi.ensureSize(4096);
+
+  for (int block = 0; block < numBlocks; ++block) {
+    // Parameter moves between blocks: note range, arp rate, waveform
+    if (block % 250 == 0) {
+      const int low = 36 + random.nextInt(24);
+      const int high = low + 12 + random.nextInt(36);
+      setParameter(processor, "lowNote", (float)low);
+      setParameter(processor, "highNote", (float)high);
+      setParameter(processor, "arpRate", (float)random.nextInt(6));
+      setParameter(processor, "oscType", (float)random.nextInt(8));
+    }
+
+    const int numSamples = 1 + random.nextInt(maxBlockSize);
+    buffer.setSize(2, numSamples, false, false, true);
+    midi.clear();
+    addRandomEvents(random, midi, numSamples);
+
+    processor.processBlock(buffer, midi);
+    playHead.ppq += numSamples * playHead.bpm / (60.0 * sampleRate);
+  }
+}
+
+} // namespace
+
+int main() {
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+  MySynthAudioProcessor processor;
+  TestPlayHead playHead;
+  processor.setPlayHead(&playHead);
+  processor.setPlayConfigDetails(0, 2, sampleRate, maxBlockSize);
+  processor.prepareToPlay(sampleRate, maxBlockSize);
+
+  for (const auto &scenario : scenarios)
+    runScenario(processor, playHead, scenario);
+
+  processor.releaseResources();
+  std::printf("No allocations in %d blocks per scenario\n", numBlocks);
+  return 0;
+}
@@ -0,0 +1,53 @@
+#include "Tests.h"
+
+#include <cstring>
+
+namespace {
+
+struct Test {
+  const char *name;
+  bool (*run)();
+};
+
+constexpr Test tests[] = {
+#if MYSYNTH_JUCE_TESTS
+    {"MidiEventQueue", &Tests::runMidiEventQueueTests},
+    {"VoiceManager", &Tests::runVoiceManagerTests},
+#else
+    {"ChordTables", &Tests::runChordTableTests},
+    {"ArpScheduler", &Tests::runArpSchedulerTests},
+#endif
+};
+
+} // namespace
+
+// Runs every test, or only those named on the command line. Exits non-zero
+// if any of them fails.
+int main(int argc, char *argv[]) {
+  int numRun = 0;
+  int numFailed = 0;
+  for (const auto &test : tests) {
+    bool selected = argc <= 1;
+    for (int i = 1; i < argc; ++i)
+      selected = selected || std::strcmp(argv[i], test.name) == 0;
+
+    if (!selected)
+      continue;
+
+    std::printf("== %s ==\n", test.name);
+    const bool passed = test.run();
+    std::printf("%s\n\n", passed ? "passed" : "FAILED");
+    ++numRun;
+    numFailed += passed ? 0 : 1;
+  }
+
+  if (numRun == 0) {
+    std::printf("Unknown test. Available:");
+    for (const auto &test : tests)
+      std::printf(" %s", test.name);
+    std::printf("\n");
+    return 1;
+  }
+
+  return numFailed == 0 ? 0 : 1;
+}
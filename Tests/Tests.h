@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdio>
+
+// Tests for the parts of the plugin that do not depend on JUCE, and, in the
+// MySynthJuceTests build (MYSYNTH_JUCE_TESTS), for the ones that do. Each
+// one prints what it checked and returns false on the first kind of failure
+// it finds.
+namespace Tests {
+
+// ChordTables::ChordCache against the chord generator it replaced, for every
+// note range, modifier mask and root
+bool runChordTableTests();
+
+// ArpScheduler over hours of timeline in random block sizes, free-running
+// and on the host's PPQ position: every step fires once, within a sample of
+// its ideal position
+bool runArpSchedulerTests();
+
+// MidiEventQueue filled to capacity, directly and through merge(): the
+// release reserve takes every note-off the other events left no room for
+bool runMidiEventQueueTests();
+
+// VoiceManager note handling on the paths that hold note-ons back until
+// every event at their sample is in
+bool runVoiceManagerTests();
+
+} // namespace Tests